@@ -0,0 +1,10 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../../source/Profiler.hpp"
+#include "../../source/Time.inl"
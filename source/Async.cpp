@@ -0,0 +1,143 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Async.hpp"
+#include <thread>
+
+
+namespace Langulus::Flow
+{
+   namespace
+   {
+
+      /// Number of active drivers in the current thread                      
+      thread_local Count Drivers = 0;
+
+      /// Number of times a flow was parked in the current thread             
+      thread_local Count Parked = 0;
+
+   } // namespace Langulus::Flow::<anonymous>
+
+
+   /// Check if the task has finished executing, either by returning, or by   
+   /// throwing an exception                                                  
+   ///   @return true if task is done                                         
+   bool Task::IsDone() const noexcept {
+      return not mState or mState->mHandle.done();
+   }
+
+   /// Check if the task has finished by throwing an exception                
+   ///   @return true if task failed                                          
+   bool Task::IsFailed() const noexcept {
+      return mState and mState->mHandle.done()
+         and mState->mHandle.promise().mException;
+   }
+
+   /// Resume the task, if whatever it awaits is ready                        
+   /// The task is resumed only if it is suspended on a readiness condition,  
+   /// so that nothing else can resume it twice                               
+   ///   @return true if task is done                                         
+   bool Task::Poll() {
+      if (IsDone())
+         return true;
+
+      auto& promise = mState->mHandle.promise();
+      if (not promise.mReady or not promise.mReady())
+         return false;
+
+      promise.mReady = {};
+      promise.mBlock = {};
+      mState->mHandle.resume();
+      return mState->mHandle.done();
+   }
+
+   /// Block the current thread until task is done. Instead of spinning, the  
+   /// thread sleeps on whatever the task currently awaits, and resumes the   
+   /// task once it's ready, until the task completes                         
+   void Task::Wait() {
+      while (not Poll()) {
+         auto& promise = mState->mHandle.promise();
+         if (promise.mBlock)
+            promise.mBlock();
+         else
+            ::std::this_thread::yield();
+      }
+   }
+
+   /// Take the result of a completed task                                    
+   ///   @attention assumes task is done                                      
+   ///   @return the co_returned value, or rethrows escaped exceptions        
+   Many Task::TakeResult() {
+      LANGULUS_ASSUME(DevAssumes, IsDone(), "Task isn't done");
+      if (not mState)
+         return {};
+
+      auto& promise = mState->mHandle.promise();
+      if (promise.mException)
+         ::std::rethrow_exception(promise.mException);
+      return Abandon(promise.mResult);
+   }
+
+   /// Notify that a flow was parked waiting for a task                       
+   void Task::Park() noexcept {
+      ++Parked;
+   }
+
+   /// Check if pending tasks can be parked in the current thread             
+   ///   @return true if a Task::Driver is active                             
+   bool Task::CanPark() noexcept {
+      return Drivers > 0;
+   }
+
+   /// Get the number of times a flow was parked in the current thread        
+   /// Compare before and after an execution, to check if anything parked     
+   ///   @return the number of parks                                          
+   Count Task::GetParkedCount() noexcept {
+      return Parked;
+   }
+
+   /// Allow parking tasks in the current thread                              
+   Task::Driver::Driver() noexcept {
+      ++Drivers;
+   }
+
+   /// Disallow parking tasks in the current thread, if last driver           
+   Task::Driver::~Driver() {
+      --Drivers;
+   }
+
+   /// Poll all tasks inside a verb output                                    
+   ///   @param output - the verb output                                      
+   ///   @return true if no tasks are pending                                 
+   bool Inner::PollTasks(Many& output) {
+      if (not output.Is<Task>())
+         return true;
+
+      bool done = true;
+      for (Count i = 0; i < output.GetCount(); ++i)
+         done &= output.Get<Task>(i).Poll();
+      return done;
+   }
+
+   /// Wait for all tasks inside a verb output, and substitute them with      
+   /// their results. Exceptions that escaped the tasks are rethrown          
+   ///   @param output - [in/out] the verb output                             
+   void Inner::ResolveTasks(Many& output) {
+      if (not output.Is<Task>())
+         return;
+
+      auto results = Many::FromState(output);
+      for (Count i = 0; i < output.GetCount(); ++i) {
+         auto& task = output.Get<Task>(i);
+         task.Wait();
+         results.SmartPush(IndexBack, task.TakeResult());
+      }
+
+      output = Abandon(results);
+   }
+
+} // namespace Langulus::Flow
@@ -0,0 +1,201 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Common.hpp"
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+
+
+namespace Langulus::Flow
+{
+
+   ///                                                                        
+   ///   Asynchronous verb task                                               
+   ///                                                                        
+   ///   A coroutine, that a verb ability can push to the verb's output,      
+   /// instead of blocking until a future/awaitable completes. The task       
+   /// starts executing immediately, and runs until the first co_await that   
+   /// isn't ready. When the executor encounters a pending task inside a      
+   /// non-integrating AND scope, while a Task::Driver is active (such as     
+   /// inside Temporal::Update), it parks that branch of the flow, and keeps  
+   /// executing the independent ones. The parked branch is polled and        
+   /// resumed on each following execution of the same scope. In any other    
+   /// case, the executor simply waits for the task to complete.              
+   ///   The value passed to co_return becomes the output of the verb.        
+   ///                                                                        
+   class Task {
+   public:
+      LANGULUS(NAME) "Task";
+
+      struct promise_type;
+      using Handle = ::std::coroutine_handle<promise_type>;
+
+      class Driver;
+
+   private:
+      /// Shared coroutine state - tasks are copied around in containers,     
+      /// but the coroutine frame is destroyed only once                      
+      struct State {
+         Handle mHandle;
+
+         State(Handle h) noexcept
+            : mHandle {h} {}
+         State(const State&) = delete;
+
+         ~State() {
+            if (mHandle)
+               mHandle.destroy();
+         }
+      };
+
+      ::std::shared_ptr<State> mState;
+
+      template<class T>
+      struct FutureAwaiter;
+      struct TaskAwaiter;
+
+   public:
+      Task() = default;
+      Task(Handle h)
+         : mState {::std::make_shared<State>(h)} {}
+
+      NOD() LANGULUS_API(FLOW) bool IsDone() const noexcept;
+      NOD() LANGULUS_API(FLOW) bool IsFailed() const noexcept;
+      LANGULUS_API(FLOW) bool Poll();
+      LANGULUS_API(FLOW) void Wait();
+      NOD() LANGULUS_API(FLOW) Many TakeResult();
+
+      NOD() bool operator == (const Task&) const noexcept = default;
+
+      LANGULUS_API(FLOW) static void Park() noexcept;
+      NOD() LANGULUS_API(FLOW) static bool CanPark() noexcept;
+      NOD() LANGULUS_API(FLOW) static Count GetParkedCount() noexcept;
+   };
+
+
+   ///                                                                        
+   ///   Coroutine promise for asynchronous verb tasks                        
+   ///                                                                        
+   struct Task::promise_type {
+      // The value that was co_returned                                 
+      Many mResult;
+      // Exception that escaped the coroutine, if any                   
+      ::std::exception_ptr mException;
+      // The condition the coroutine is currently waiting on            
+      ::std::function<bool()> mReady;
+      // Blocks the calling thread until that condition is satisfied    
+      ::std::function<void()> mBlock;
+
+      Task get_return_object() noexcept {
+         return Task {Handle::from_promise(*this)};
+      }
+
+      // Tasks start executing immediately, and are retained after      
+      // they complete, so that their results can be collected          
+      ::std::suspend_never initial_suspend() noexcept { return {}; }
+      ::std::suspend_always final_suspend() noexcept { return {}; }
+
+      void unhandled_exception() noexcept {
+         mException = ::std::current_exception();
+      }
+
+      template<class T>
+      void return_value(T&& value) {
+         mResult = Many {Forward<T>(value)};
+      }
+
+      // Only standard futures and other tasks can be awaited, because  
+      // the task is resumed only by Poll, once the condition they set  
+      // is satisfied - awaitables that resume the coroutine by         
+      // themselves would end up being resumed twice                    
+      template<class T>
+      FutureAwaiter<T> await_transform(::std::future<T>&& future) noexcept {
+         return {Move(future)};
+      }
+
+      TaskAwaiter await_transform(const Task&) noexcept;
+   };
+
+
+   ///                                                                        
+   ///   Awaits a standard future, by polling it on each resumption attempt   
+   ///                                                                        
+   template<class T>
+   struct Task::FutureAwaiter {
+      ::std::future<T> mFuture;
+
+      bool IsReady() const {
+         return mFuture.wait_for(::std::chrono::seconds {0})
+             == ::std::future_status::ready;
+      }
+
+      bool await_ready() const {
+         return IsReady();
+      }
+
+      void await_suspend(Handle h) {
+         h.promise().mReady = [this] { return IsReady(); };
+         h.promise().mBlock = [this] { mFuture.wait(); };
+      }
+
+      T await_resume() {
+         return mFuture.get();
+      }
+   };
+
+
+   ///                                                                        
+   ///   Awaits another task, by polling it on each resumption attempt        
+   ///                                                                        
+   struct Task::TaskAwaiter {
+      Task mTask;
+
+      bool await_ready() {
+         return mTask.Poll();
+      }
+
+      void await_suspend(Handle h) {
+         h.promise().mReady = [this] { return mTask.Poll(); };
+         h.promise().mBlock = [this] { mTask.Wait(); };
+      }
+
+      Many await_resume() {
+         return mTask.TakeResult();
+      }
+   };
+
+   inline Task::TaskAwaiter Task::promise_type::await_transform(const Task& task) noexcept {
+      return {task};
+   }
+
+
+   ///                                                                        
+   ///   Allows the executor to park pending tasks in the current thread,     
+   /// instead of waiting for them, for as long as the driver exists.         
+   /// Whoever creates a driver is responsible for executing the parked       
+   /// flows again, until all their tasks are done                            
+   ///                                                                        
+   class Task::Driver {
+   public:
+      Driver(const Driver&) = delete;
+      Driver(Driver&&) = delete;
+
+      LANGULUS_API(FLOW) Driver() noexcept;
+      LANGULUS_API(FLOW) ~Driver();
+   };
+
+   namespace Inner
+   {
+      NOD() LANGULUS_API(FLOW) bool PollTasks(Many&);
+      LANGULUS_API(FLOW) void ResolveTasks(Many&);
+   }
+
+} // namespace Langulus::Flow
@@ -0,0 +1,184 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Budget.hpp"
+#include "Time.inl"
+
+
+namespace Langulus::Flow
+{
+   namespace
+   {
+
+      /// Budget state for the current thread                                 
+      struct BudgetState {
+         // The installed budget                                        
+         Budget mBudget;
+         // Number of verbs executed so far                             
+         Count mSpent {};
+         // Point in time, after which execution is suspended           
+         TimePoint mDeadline;
+         // Number of nested regions that can't be suspended            
+         Count mLocks {};
+         // Whether or not a budget is currently installed              
+         bool mActive {};
+         // Whether or not budget was exhausted, and execution suspended
+         bool mSuspended {};
+      };
+
+      thread_local BudgetState State;
+
+   } // namespace Langulus::Flow::<anonymous>
+
+
+   /// Check if a budget is installed in the current thread                   
+   ///   @return true if a budget is active                                   
+   bool Budget::IsActive() noexcept {
+      return State.mActive;
+   }
+
+   /// Check if the active budget was exhausted, suspending execution         
+   ///   @return true if execution was suspended                              
+   bool Budget::IsSuspended() noexcept {
+      return State.mSuspended;
+   }
+
+   /// Get what's left of the budget installed in the current thread, so      
+   /// that it can be installed in other threads                              
+   ///   @param remaining - [out] the remaining budget, unlimited if no budget
+   ///      is active                                                         
+   ///   @return false if the active budget is already exhausted              
+   bool Budget::GetRemaining(Budget& remaining) noexcept {
+      remaining = {};
+      if (not State.mActive)
+         return true;
+      if (State.mSuspended)
+         return false;
+
+      if (State.mBudget.mVerbs) {
+         if (State.mSpent >= State.mBudget.mVerbs)
+            return false;
+         remaining.mVerbs = State.mBudget.mVerbs - State.mSpent;
+      }
+
+      if (State.mBudget.mTime) {
+         const auto now = SteadyClock::Now();
+         if (now >= State.mDeadline)
+            return false;
+         remaining.mTime = State.mDeadline - now;
+      }
+      return true;
+   }
+
+   /// Install a budget for the current thread, unless one is already active  
+   ///   @param budget - the budget to install                                
+   Budget::Scope::Scope(const Budget& budget) {
+      if (State.mActive or not budget.IsLimited())
+         return;
+
+      State.mBudget = budget;
+      State.mSpent = 0;
+      State.mLocks = 0;
+      State.mSuspended = false;
+      if (budget.mTime)
+         State.mDeadline = SteadyClock::Now() + budget.mTime;
+      State.mActive = true;
+      mInstalled = true;
+   }
+
+   /// Uninstall the budget, if this scope installed it                       
+   Budget::Scope::~Scope() {
+      if (mInstalled)
+         State = {};
+   }
+
+   /// Lend a share of the budget to the current thread                       
+   ///   @param share - the share, unlimited shares change nothing            
+   Budget::Share::Share(const Budget& share) {
+      if (not share.IsLimited())
+         return;
+
+      if (not State.mActive) {
+         State.mBudget = share;
+         State.mSpent = 0;
+         State.mLocks = 0;
+         State.mSuspended = false;
+         if (share.mTime)
+            State.mDeadline = SteadyClock::Now() + share.mTime;
+         State.mActive = true;
+         mInstalled = true;
+         return;
+      }
+
+      // Cap the active budget, so that no more than the share can be   
+      // spent - time is shared between threads anyways                 
+      mPrevious = State.mBudget;
+      mCapped = true;
+      if (share.mVerbs) {
+         const auto cap = State.mSpent + share.mVerbs;
+         if (not State.mBudget.mVerbs or cap < State.mBudget.mVerbs)
+            State.mBudget.mVerbs = cap;
+      }
+   }
+
+   /// Return the share, restoring the budget that was capped                 
+   Budget::Share::~Share() {
+      if (mInstalled)
+         State = {};
+      else if (mCapped) {
+         // Running out of the share doesn't mean the budget ran out,   
+         // suspension is computed again on the next verb               
+         State.mBudget = mPrevious;
+         State.mSuspended = false;
+      }
+   }
+
+   /// Begin tracking the suspension of a single flow                         
+   Budget::Frame::Frame() noexcept
+      : mSuspended {State.mSuspended} {
+      // Suspension is computed again on the next verb, so flows that   
+      // have nothing left to execute aren't reported as suspended      
+      State.mSuspended = false;
+   }
+
+   /// Stop tracking the suspension of a single flow                          
+   Budget::Frame::~Frame() {
+      State.mSuspended = State.mSuspended or mSuspended;
+   }
+
+   /// Begin a region that can't be suspended                                 
+   Budget::Lock::Lock() noexcept {
+      ++State.mLocks;
+   }
+
+   /// End a region that can't be suspended                                   
+   Budget::Lock::~Lock() {
+      --State.mLocks;
+   }
+
+   /// Spend a single verb from the active budget, if any. Called by the      
+   /// executor at each verb boundary, where suspension is possible           
+   ///   @return true if verb can be executed, false if execution must be     
+   ///      suspended                                                         
+   bool Inner::ConsumeBudget() noexcept {
+      if (not State.mActive or State.mLocks)
+         return true;
+      if (State.mSuspended)
+         return false;
+
+      if ((State.mBudget.mVerbs and State.mSpent >= State.mBudget.mVerbs)
+      or  (State.mBudget.mTime  and SteadyClock::Now() >= State.mDeadline)) {
+         // Out of budget, suspend until next time                      
+         State.mSuspended = true;
+         return false;
+      }
+
+      ++State.mSpent;
+      return true;
+   }
+
+} // namespace Langulus::Flow
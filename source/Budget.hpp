@@ -0,0 +1,123 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Time.hpp"
+
+
+namespace Langulus::Flow
+{
+
+   ///                                                                        
+   ///   Execution budget                                                     
+   ///                                                                        
+   /// Limits the number of verbs and/or the wall time a flow is allowed to   
+   /// consume, before being suspended. Suspension happens only at verb       
+   /// boundaries of non-integrating AND scopes - the position in the scope   
+   /// tree is retained by the done-state of the already executed verbs, so   
+   /// executing the same scope again resumes where it left off               
+   ///                                                                        
+   struct Budget {
+      // Maximum number of verbs to execute, zero for unlimited         
+      Count mVerbs {};
+      // Maximum wall time to execute for, zero for unlimited           
+      Time mTime {};
+
+      /// Check if budget imposes any limits                                  
+      ///   @return true if verbs or time are limited                         
+      NOD() LANGULUS(INLINED)
+      bool IsLimited() const noexcept {
+         return mVerbs or mTime;
+      }
+
+      NOD() LANGULUS_API(FLOW) static bool IsActive() noexcept;
+      NOD() LANGULUS_API(FLOW) static bool IsSuspended() noexcept;
+      NOD() LANGULUS_API(FLOW) static bool GetRemaining(Budget&) noexcept;
+
+      class Scope;
+      class Share;
+      class Frame;
+      class Lock;
+   };
+
+
+   ///                                                                        
+   ///   Installs a budget for all executions in the current thread, until    
+   /// destroyed. If a budget is already active, the outer one is retained,   
+   /// so that sub-flows share the budget of their parents                    
+   ///                                                                        
+   class Budget::Scope {
+      bool mInstalled {};
+
+   public:
+      Scope() = delete;
+      Scope(const Scope&) = delete;
+      Scope(Scope&&) = delete;
+
+      LANGULUS_API(FLOW) Scope(const Budget&);
+      LANGULUS_API(FLOW) ~Scope();
+   };
+
+
+   ///                                                                        
+   ///   Lends a share of a budget to the current thread, until destroyed,    
+   /// used to split a budget between threads. If a budget is active in this  
+   /// thread, it is capped to the share, and whatever is spent is charged    
+   /// to it as usual - otherwise the share is installed as a new budget      
+   ///                                                                        
+   class Budget::Share {
+      Budget mPrevious;
+      bool mCapped {};
+      bool mInstalled {};
+
+   public:
+      Share() = delete;
+      Share(const Share&) = delete;
+      Share(Share&&) = delete;
+
+      LANGULUS_API(FLOW) Share(const Budget&);
+      LANGULUS_API(FLOW) ~Share();
+   };
+
+
+   ///                                                                        
+   ///   Isolates the suspension of a single flow, that shares a budget with  
+   /// other flows. Execution is suspended only if the budget runs out while  
+   /// the frame exists - suspensions of flows executed before it are         
+   /// restored when destroyed                                                
+   ///                                                                        
+   class Budget::Frame {
+      bool mSuspended;
+
+   public:
+      Frame(const Frame&) = delete;
+      Frame(Frame&&) = delete;
+
+      LANGULUS_API(FLOW) Frame() noexcept;
+      LANGULUS_API(FLOW) ~Frame();
+   };
+
+
+   ///                                                                        
+   ///   Marks a region that must never be suspended midway, such as verb     
+   /// integration or OR scopes, that can't be resumed                        
+   ///                                                                        
+   class Budget::Lock {
+   public:
+      Lock(const Lock&) = delete;
+      Lock(Lock&&) = delete;
+
+      LANGULUS_API(FLOW) Lock() noexcept;
+      LANGULUS_API(FLOW) ~Lock();
+   };
+
+   namespace Inner
+   {
+      NOD() LANGULUS_API(FLOW) bool ConsumeBudget() noexcept;
+   }
+
+} // namespace Langulus::Flow
@@ -6,10 +6,18 @@
 /// SPDX-License-Identifier: GPL-3.0-or-later                                 
 ///                                                                           
 #include "Executor.hpp"
+#include "Profiler.hpp"
+#include "Budget.hpp"
+#include "Async.hpp"
+#include "Memo.hpp"
+#include "inner/Workers.hpp"
+#include "inner/Incremental.hpp"
+#include "inner/Dispatch.hpp"
 #include "verbs/Do.inl"
 #include "verbs/Interpret.inl"
 #include "verbs/Create.inl"
 #include "inner/Missing.hpp"
+#include <algorithm>
 
 #if 0
    #define VERBOSE(...)      Logger::Verbose(__VA_ARGS__)
@@ -25,6 +33,214 @@
 namespace Langulus::Flow
 {
 
+   namespace Inner
+   {
+      bool ExecuteVerbAsync(Many&, Verb&, bool silent);
+   }
+
+   namespace
+   {
+
+      /// Wait for any asynchronous tasks inside a verb output, and           
+      /// substitute them with their results                                  
+      ///   @param output - [in/out] the verb output                          
+      ///   @param silent - whether or not to silence logging                 
+      ///   @return true if no task failed                                    
+      bool ResolveTasks(Many& output, const bool silent) {
+         try { Inner::ResolveTasks(output); }
+         catch (...) {
+            if (not silent)
+               FLOW_ERRORS("Asynchronous verb task failed");
+            return false;
+         }
+
+         return true;
+      }
+
+      /// Check if a scope can be integrated without a context, i.e. it       
+      /// contains no missing points, and only pure verbs with explicit       
+      /// sources, that don't depend on it. Constructs are never integrated   
+      /// in advance, because each context must get its own instance          
+      ///   @param scope - the scope to check                                 
+      ///   @return true if scope doesn't depend on any context               
+      bool IsContextIndependent(const Many& scope) {
+         if (scope.IsDeep()) {
+            // Sparse scopes act as handles, that can change externally 
+            if (scope.IsSparse())
+               return false;
+
+            bool independent = true;
+            scope.ForEach([&](const Many& subscope) {
+               independent = IsContextIndependent(subscope);
+               return independent ? Loop::Continue : Loop::Break;
+            });
+            return independent;
+         }
+
+         bool independent = true;
+         scope.ForEach(
+            [&](const A::Verb& verb) {
+               // Verbs without a source are executed in the context    
+               independent = Memo::IsPure(verb.GetVerb())
+                  and verb.GetSource()
+                  and IsContextIndependent(verb.GetSource())
+                  and IsContextIndependent(verb.GetArgument());
+               return independent ? Loop::Continue : Loop::Break;
+            },
+            [&](const Inner::Missing&) {
+               independent = false;
+               return Loop::Break;
+            },
+            [&](const Neat&) {
+               // Neats might contain verbs - be conservative           
+               independent = false;
+               return Loop::Break;
+            },
+            [&](const Trait& trait) {
+               independent = IsContextIndependent(trait);
+               return independent ? Loop::Continue : Loop::Break;
+            },
+            [&](const Construct&) {
+               independent = false;
+               return Loop::Break;
+            }
+         );
+         return independent;
+      }
+
+      Many PrepareBatch(const Many&, bool integrate, bool silent);
+
+      /// Prepare a verb source or argument for batched execution             
+      ///   @param part - the source or argument to prepare                   
+      ///   @param integrate - whether to integrate context-independent parts 
+      ///   @param silent - whether or not to silence logging                 
+      ///   @return the prepared part                                         
+      Many PrepareBatchPart(const Many& part, const bool integrate, const bool silent) {
+         if (integrate and part and IsContextIndependent(part)) {
+            // Integrate it once, instead of once per context           
+            Many unusedContext;
+            Many local;
+            if (Execute(part, unusedContext, local, true, silent))
+               return Abandon(local);
+         }
+
+         return PrepareBatch(part, integrate, silent);
+      }
+
+      /// Replicate the structure of a flow for batched execution. Every      
+      /// container that has verbs in it is rebuilt, because executing a      
+      /// flow marks verbs as done; anything else is shallow-copied           
+      ///   @param scope - the flow to prepare                                
+      ///   @param integrate - whether to integrate context-independent       
+      ///      sources and arguments, while replicating                       
+      ///   @param silent - whether or not to silence logging                 
+      ///   @return the prepared flow                                         
+      Many PrepareBatch(const Many& scope, const bool integrate, const bool silent) {
+         Many result;
+         if (scope.IsOr())
+            result.MakeOr();
+
+         if (scope.IsDeep()) {
+            if (scope.IsSparse())
+               return scope;
+
+            scope.ForEach([&](const Many& subscope) {
+               result << PrepareBatch(subscope, integrate, silent);
+            });
+            return Abandon(result);
+         }
+
+         const auto done = scope.ForEach(
+            [&](const Trait& subscope) {
+               result << Trait::From(
+                  subscope.GetTrait(),
+                  PrepareBatch(subscope, integrate, silent)
+               );
+            },
+            [&](const Construct& subscope) {
+               result << Construct {
+                  subscope.GetType(),
+                  PrepareBatch(subscope.GetDescriptor(), integrate, silent),
+                  subscope.GetCharge()
+               };
+            },
+            [&](const A::Verb& subscope) {
+               auto v = Verb::FromMeta(
+                  subscope.GetVerb(),
+                  PrepareBatchPart(subscope.GetArgument(), integrate, silent),
+                  subscope.GetCharge(),
+                  subscope.GetVerbState()
+               ).SetSource(
+                  PrepareBatchPart(subscope.GetSource(), integrate, silent)
+               );
+               result << Abandon(v);
+            }
+         );
+
+         if (not done) {
+            // Just propagate content                                   
+            result = scope;
+         }
+
+         return Abandon(result);
+      }
+
+   } // namespace Langulus::Flow::<anonymous>
+
+   /// Check if a flow can be executed in different threads at the same time, 
+   /// i.e. all verbs inside were marked thread-safe, and it has no sparse    
+   /// handles, that would be shared between threads                          
+   ///   @param scope - the flow to check                                     
+   ///   @param exclusive - whether to also require that no block inside is   
+   ///      referenced from anywhere else, because reference counts aren't    
+   ///      atomic; needed when the flow itself is executed in another thread 
+   ///      instead of a replica                                              
+   ///   @return true if flow is safe to execute in parallel                  
+   bool Inner::IsThreadSafeFlow(const Many& scope, const bool exclusive) {
+      if (exclusive and scope.IsAllocated() and scope.GetUses() > 1)
+         return false;
+
+      if (scope.IsDeep()) {
+         if (scope.IsSparse())
+            return false;
+
+         bool safe = true;
+         scope.ForEach([&](const Many& subscope) {
+            safe = IsThreadSafeFlow(subscope, exclusive);
+            return safe ? Loop::Continue : Loop::Break;
+         });
+         return safe;
+      }
+
+      bool safe = true;
+      scope.ForEach(
+         [&](const A::Verb& verb) {
+            safe = IsThreadSafe(verb.GetVerb())
+               and IsThreadSafeFlow(verb.GetSource(), exclusive)
+               and IsThreadSafeFlow(verb.GetArgument(), exclusive);
+            return safe ? Loop::Continue : Loop::Break;
+         },
+         [&](const Missing& missing) {
+            safe = IsThreadSafeFlow(missing.mContent, exclusive);
+            return safe ? Loop::Continue : Loop::Break;
+         },
+         [&](const Neat&) {
+            // Neats might contain verbs - be conservative              
+            safe = false;
+            return Loop::Break;
+         },
+         [&](const Trait& trait) {
+            safe = IsThreadSafeFlow(trait, exclusive);
+            return safe ? Loop::Continue : Loop::Break;
+         },
+         [&](const Construct& construct) {
+            safe = IsThreadSafeFlow(construct.GetDescriptor(), exclusive);
+            return safe ? Loop::Continue : Loop::Break;
+         }
+      );
+      return safe;
+   }
+
    /// Nested AND/OR scope execution with output                              
    ///   @param flow - the flow to execute                                    
    ///   @param context - the environment in which scope will be executed     
@@ -139,6 +355,8 @@ namespace Langulus::Flow
                   return;
                }
 
+               // Traits can't be partially executed                    
+               const Budget::Lock lock;
                Many local;
                if (not Execute(trait, context, local, integrate, skipVerbs, silent)) {
                   if (silent)
@@ -153,6 +371,8 @@ namespace Langulus::Flow
                // Nest if constructs, but retain each construct         
                VERBOSE("Executing construct: ", construct);
 
+               // Constructs can't be partially executed                
+               const Budget::Lock lock;
                Many local;
                if (not Execute(construct.GetDescriptor(), context, local, integrate, skipVerbs, silent)) {
                   if (silent)
@@ -233,6 +453,47 @@ namespace Langulus::Flow
                   return Loop::Continue;
                }
 
+               // Reuse the output of a stable verb from a previous tick
+               // of the periodic flow, without integrating it again    
+               auto& original = const_cast<A::Verb&>(constVerb);
+               const auto incremental = Inner::Incremental::GetActive();
+               if (incremental and incremental->Recall(constVerb, output)) {
+                  original.Done();
+                  return Loop::Continue;
+               }
+
+               if (not integrate and not Inner::ConsumeBudget()) {
+                  // Out of budget - suspend at this verb. Verbs that   
+                  // were already executed are marked done, so executing
+                  // the same scope again resumes from here             
+                  return Loop::Break;
+               }
+
+               // Parking is allowed only when not integrating, and     
+               // only if someone is going to execute the scope again   
+               const bool parkable = not integrate and Task::CanPark();
+
+               if (original.GetOutput().template Is<Task>()) {
+                  // Verb was parked on a previous execution, waiting   
+                  // for its tasks to complete                          
+                  if (parkable and not Inner::PollTasks(original.GetOutput())) {
+                     Task::Park();
+                     return Loop::Break;
+                  }
+
+                  Many results = Move(original.GetOutput());
+                  if (not ResolveTasks(results, silent)) {
+                     if (silent)
+                        LANGULUS_THROW(Flow, "Asynchronous verb AND failure");
+                     else
+                        LANGULUS_OOPS(Flow, "Asynchronous verb AND failure: ", constVerb);
+                  }
+
+                  original.Done();
+                  output.SmartPush(IndexBack, Abandon(results));
+                  return Loop::Continue;
+               }
+
                // Shallow-copy the verb to make it mutable              
                // Also resets its output                                
                auto verb = Verb::FromMeta(
@@ -244,16 +505,36 @@ namespace Langulus::Flow
                verb.SetSource(constVerb.GetSource());
 
                // Execute the verb                                      
-               if (not ExecuteVerb(context, verb, silent)) {
+               if (not Inner::ExecuteVerbAsync(context, verb, silent)) {
                   if (silent)
                      LANGULUS_THROW(Flow, "Verb AND failure");
                   else
                      LANGULUS_OOPS(Flow, "Verb AND failure: ", verb);
                }
 
+               if (parkable and not Inner::PollTasks(verb.GetOutput())) {
+                  // The verb is waiting on something - park this       
+                  // branch, retaining the pending tasks inside the     
+                  // original verb. The rest of the scope is resumed    
+                  // after they complete                                
+                  original.GetOutput() = Move(verb.GetOutput());
+                  Task::Park();
+                  return Loop::Break;
+               }
+
+               if (not ResolveTasks(verb.GetOutput(), silent)) {
+                  if (silent)
+                     LANGULUS_THROW(Flow, "Asynchronous verb AND failure");
+                  else
+                     LANGULUS_OOPS(Flow, "Asynchronous verb AND failure: ", verb);
+               }
+
+               if (incremental)
+                  incremental->Remember(constVerb, verb.GetOutput(), context);
+
                // Make sure the original verb has been marked done, so  
                // that it isn't executed every time.                    
-               const_cast<A::Verb&>(constVerb).Done();
+               original.Done();
                output.SmartPush(IndexBack, Abandon(verb.GetOutput()));
                return Loop::Continue;
             }
@@ -287,6 +568,8 @@ namespace Langulus::Flow
       const Many& flow, Many& context, Many& output,
       const bool integrate, bool& skipVerbs, const bool silent
    ) {
+      // OR scopes don't mark their verbs as done, so they can't resume 
+      const Budget::Lock lock;
       Count executed = 0;
       bool localSkipVerbs = false;
 
@@ -451,6 +734,93 @@ namespace Langulus::Flow
       return true;
    }
 
+   namespace Inner
+   {
+
+      /// Execute a single verb, and all subverbs in it, if any               
+      /// This is the unprofiled implementation, see Flow::ExecuteVerb        
+      ///   @param context - [in/out] the context for execution               
+      ///   @param verb - [in/out] verb to execute                            
+      ///   @param silent - whether or not to silence logging                 
+      ///   @return true of no errors occured                                 
+      bool ExecuteVerb(Many& context, Verb& verb, const bool silent) {
+         // Suspension can only happen between verbs, never inside one  
+         const Budget::Lock lock;
+
+         // Integration (and execution of subverbs if any)              
+         // Source and argument will be executed locally if scripts, and
+         // substituted with their results in the verb                  
+         if (not IntegrateVerb(context, verb, silent)) {
+            if (not silent) {
+               FLOW_ERRORS("Error integrating verb: ",
+                  verb, " (", verb.GetVerb(), ')');
+            }
+            return false;
+         }
+
+         if (verb.IsVerb<Verbs::Do>()) {
+            // A Do verb is done at this point, because the subverbs    
+            // inside (if any) should be done in the integration phase  
+            // Just making sure that the integrated argument & source are
+            // propagated to the verb's output                          
+            if (not verb.GetOutput()) {
+               if (verb)
+                  verb << Move(verb.GetArgument());
+               else
+                  verb << Move(verb.GetSource());
+            }
+
+            return true;
+         }
+
+         // Recall pure verbs, that were already executed with the same 
+         // integrated source and argument                              
+         const auto memo = Memo::GetActive();
+         if (memo and memo->Recall(verb)) {
+            VERBOSE("Recalled: ",
+               Logger::Green, verb, " (", verb.GetVerb(), ')');
+            return true;
+         }
+
+         VERBOSE_TAB("Executing verb: ",
+            Logger::Cyan, verb, " (", verb.GetVerb(), ')');
+
+         // Dispatch the verb to the context, executing it              
+         // Any results should be inside verb.mOutput afterwards        
+         Many contextCopy = verb.GetSource();
+         if (not Flow::DispatchDeep(contextCopy, verb)) {
+            if (not silent) {
+               FLOW_ERRORS("Error executing verb: ",
+                  verb, " (", verb.GetVerb(), ')');
+            }
+            return false;
+         }
+
+         if (memo)
+            memo->Remember(verb);
+
+         VERBOSE("Executed: ",
+            Logger::Green, verb, " (", verb.GetVerb(), ')');
+         return true;
+      }
+
+      /// Execute a single verb, profiling it if enabled. Any asynchronous    
+      /// tasks the verb produces are left pending in its output              
+      ///   @param context - [in/out] the context for execution               
+      ///   @param verb - [in/out] verb to execute                            
+      ///   @param silent - whether or not to silence logging                 
+      ///   @return true of no errors occured                                 
+      bool ExecuteVerbAsync(Many& context, Verb& verb, const bool silent) {
+         if (Profiler::IsEnabled()) {
+            Profiler::Scope profile {verb.GetVerb(), Profiler::Stage::Execute};
+            return profile.Complete(ExecuteVerb(context, verb, silent));
+         }
+
+         return ExecuteVerb(context, verb, silent);
+      }
+
+   } // namespace Langulus::Flow::Inner
+
    /// Execute a single verb, and all subverbs in it, if any                  
    ///   @param context - [in/out] the context in which verb will be executed 
    ///   @param verb - [in/out] verb to execute                               
@@ -458,49 +828,133 @@ namespace Langulus::Flow
    ///      executing at compile-time, for example                            
    ///   @return true of no errors occured                                    
    bool ExecuteVerb(Many& context, Verb& verb, const bool silent) {
-      // Integration (and execution of subverbs if any)                 
-      // Source and argument will be executed locally if scripts, and   
-      // substituted with their results in the verb                     
-      if (not IntegrateVerb(context, verb, silent)) {
-         if (not silent) {
-            FLOW_ERRORS("Error integrating verb: ",
-               verb, " (", verb.GetVerb(), ')');
-         }
-         return false;
-      }
+      // Wait for any asynchronous tasks, there's nowhere to park them  
+      return Inner::ExecuteVerbAsync(context, verb, silent)
+         and ResolveTasks(verb.GetOutput(), silent);
+   }
 
-      if (verb.IsVerb<Verbs::Do>()) {
-         // A Do verb is done at this point, because the subverbs       
-         // inside (if any) should be done in the integration phase     
-         // Just making sure that the integrated argument & source are  
-         // propagated to the verb's output                             
-         if (not verb.GetOutput()) {
-            if (verb)
-               verb << Move(verb.GetArgument());
-            else
-               verb << Move(verb.GetSource());
+   /// Reset progress for all verbs inside a scope                            
+   ///   @param scope - scope to reset                                        
+   void ResetProgress(Many& scope) {
+      scope.ForEach(
+         [&](Many& m) {
+            if (m.IsDense())
+               ResetProgress(m);
+         },
+         [&](Inner::Missing& missing) {
+            if (missing.mContent.IsDense())
+               ResetProgress(missing.mContent);
+         },
+         [&](Trait& trait) {
+            if (trait.IsDense())
+               ResetProgress(static_cast<Many&>(trait));
+         },
+         [&](Construct& construct) {
+            ResetProgress(construct.GetDescriptor());
+         },
+         [&](Neat& neat) {
+            neat.ForEachTrait([](Trait& trait) {
+               ResetProgress(static_cast<Many&>(trait));
+            });
+            neat.ForEachConstruct([](Construct& con) {
+               Many wrapper {con};
+               ResetProgress(wrapper);
+            });
+            neat.ForEachTail([](Many& stuff) {
+               ResetProgress(stuff);
+            });
+         },
+         [&](A::Verb& constVerb) {
+            ResetProgress(constVerb.GetSource());
+            ResetProgress(constVerb.GetArgument());
+            if (constVerb.GetOutput().template Is<Task>()) {
+               // Abandon any tasks the verb was parked on              
+               constVerb.GetOutput().Reset();
+            }
+            constVerb.Undo();
          }
+      );
+   }
 
-         return true;
-      }
-
-      VERBOSE_TAB("Executing verb: ",
-         Logger::Cyan, verb, " (", verb.GetVerb(), ')');
-
-      // Dispatch the verb to the context, executing it                 
-      // Any results should be inside verb.mOutput afterwards           
-      Many contextCopy = verb.GetSource();
-      if (not DispatchDeep(contextCopy, verb)) {
-         if (not silent) {
-            FLOW_ERRORS("Error executing verb: ",
-               verb, " (", verb.GetVerb(), ')');
+   /// Execute the same flow in many contexts. Sources and arguments, that    
+   /// don't depend on the context are integrated only once for the whole     
+   /// batch, instead of once per context                                     
+   ///   @attention contexts are executed in parallel chunks only if all      
+   ///      verbs in the flow were marked thread-safe via MarkThreadSafe,     
+   ///      all contexts are dense and not referenced from anywhere else, and 
+   ///      no budget, memoization table or task driver is active in the      
+   ///      calling thread - otherwise they're executed sequentially          
+   ///   @param flow - the flow to execute                                    
+   ///   @param contexts - [in/out] the contexts to execute in                
+   ///   @param outputs - [out] a deep container with the output for each     
+   ///      context, in the same order as contexts, is pushed here            
+   ///   @param parallel - whether or not to execute in parallel chunks       
+   ///   @param silent - whether or not to silence logging                    
+   ///   @return true if no errors occured in any of the contexts             
+   bool ExecuteBatch(
+      const Many& flow, ::std::span<Many> contexts, Many& outputs,
+      const bool parallel, const bool silent
+   ) {
+      const auto prepared = PrepareBatch(flow, true, silent);
+      TMany<Many> results;
+      results.New(contexts.size());
+
+      ::std::atomic<bool> success = true;
+      const auto run = [&](Many& replica, Count from, Count to) {
+         // Each chunk executes its own replica of the flow, because    
+         // executing marks verbs as done. Between contexts the replica 
+         // is simply reset. Incremental caches are keyed by the verbs  
+         // of their own flow, so none is used in any of the chunks     
+         const Inner::Incremental::Scope incremental {nullptr};
+         for (Count i = from; i < to; ++i) {
+            if (i != from)
+               ResetProgress(replica);
+            if (not Execute(replica, contexts[i], results[i], false, silent))
+               success.store(false, ::std::memory_order_relaxed);
          }
-         return false;
+      };
+
+      // Budgets, memoization tables and task drivers are installed per 
+      // thread, so chunks executed by workers would ignore them, while 
+      // the chunk executed by this thread would not                    
+      const bool isolated = not Budget::IsActive()
+         and not Memo::GetActive() and not Task::CanPark();
+
+      // Contexts are executed in place by the workers, and reference   
+      // counts aren't atomic, so none of them may be shared            
+      const auto exclusive = [&] {
+         return ::std::all_of(contexts.begin(), contexts.end(),
+            [](const Many& context) {
+               return context.IsDense()
+                  and Inner::IsThreadSafeFlow(context, true);
+            });
+      };
+
+      if (parallel and contexts.size() > 1 and isolated
+      and Inner::IsThreadSafeFlow(prepared) and exclusive()) {
+         // Reference counts aren't atomic, so replicas are cloned on   
+         // this thread, and workers never touch anything shared        
+         const auto count = static_cast<Count>(contexts.size());
+         const auto chunk = ::std::max(
+            count / (Inner::GetWorkerCount() * 4), Count {1});
+         const auto chunks = (count + chunk - 1) / chunk;
+         TMany<Many> replicas;
+         replicas.New(chunks);
+         for (Count i = 0; i < chunks; ++i)
+            replicas[i] = Many {Clone(prepared)};
+
+         Inner::ParallelFor(chunks, 1, [&](Count from, Count to) {
+            for (Count i = from; i < to; ++i)
+               run(replicas[i], i * chunk, ::std::min(i * chunk + chunk, count));
+         });
+      }
+      else {
+         auto replica = PrepareBatch(prepared, false, silent);
+         run(replica, 0, contexts.size());
       }
 
-      VERBOSE("Executed: ",
-         Logger::Green, verb, " (", verb.GetVerb(), ')');
-      return true;
+      outputs.SmartPush(IndexBack, Abandon(results));
+      return success;
    }
 
 } // namespace Langulus::Flow
\ No newline at end of file
@@ -7,6 +7,7 @@
 ///                                                                           
 #pragma once
 #include "Common.hpp"
+#include <span>
 
 
 namespace Langulus::Flow
@@ -30,4 +31,15 @@ namespace Langulus::Flow
    LANGULUS_API(FLOW)
    bool IntegrateVerb(Many&, Verb&, bool silent = false);
 
+   LANGULUS_API(FLOW)
+   bool ExecuteBatch(const Many&, ::std::span<Many>, Many& outputs, bool parallel = false, bool silent = false);
+   LANGULUS_API(FLOW)
+   void ResetProgress(Many&);
+
+   namespace Inner
+   {
+      NOD() LANGULUS_API(FLOW)
+      bool IsThreadSafeFlow(const Many&, bool exclusive = false);
+   }
+
 } // namespace Langulus::Flow
@@ -0,0 +1,278 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Memo.hpp"
+#include "Verb.inl"
+#include "Async.hpp"
+#include "verbs/Interpret.hpp"
+#include "verbs/Compare.hpp"
+#include "verbs/Equal.hpp"
+#include "verbs/Lower.hpp"
+#include "verbs/LowerOrEqual.hpp"
+#include "verbs/Greater.hpp"
+#include "verbs/GreaterOrEqual.hpp"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+
+namespace Langulus::Flow
+{
+   namespace
+   {
+
+      /// The memoization table, installed in the current thread              
+      thread_local Memo* Active = nullptr;
+
+      /// Registry of pure verbs, shared across all threads                   
+      /// Catenate isn't pure, because it concatenates into its context       
+      struct PureRegistry {
+         ::std::shared_mutex mMutex;
+         TMany<VMeta> mVerbs;
+
+         PureRegistry() {
+            // Built-in verbs, that depend only on their inputs         
+            mVerbs << MetaVerbOf<Verbs::Interpret>()
+                   << MetaVerbOf<Verbs::Compare>()
+                   << MetaVerbOf<Verbs::Equal>()
+                   << MetaVerbOf<Verbs::Lower>()
+                   << MetaVerbOf<Verbs::LowerOrEqual>()
+                   << MetaVerbOf<Verbs::Greater>()
+                   << MetaVerbOf<Verbs::GreaterOrEqual>();
+         }
+      };
+
+      PureRegistry& GetPureRegistry() {
+         static PureRegistry registry;
+         return registry;
+      }
+
+      /// Number of entries in each per-thread purity cache, must be power    
+      /// of two                                                              
+      constexpr Offset PurityCacheSize = 64;
+
+      /// Incremented each time a verb is marked pure or impure. Entries      
+      /// that were cached in an older generation are considered empty        
+      ::std::atomic<uint32_t> PurityGeneration {1};
+
+      /// A cached purity check                                               
+      struct PurityEntry {
+         VMeta mVerb;
+         uint32_t mGeneration {};
+         bool mPure {};
+      };
+
+      /// Direct-mapped cache - each thread has its own, so checking the      
+      /// purity of a verb takes no locks, unless it misses                   
+      thread_local PurityEntry PurityCache[PurityCacheSize];
+
+      /// Check if a block is remembered and compared by value, i.e. it       
+      /// contains only POD data, and no handles, whose contents might        
+      /// change without changing the block itself                            
+      ///   @param block - the block to check                                 
+      ///   @return true if block can be remembered                           
+      bool IsByValue(const Many& block) {
+         if (block.IsSparse())
+            return false;
+
+         if (block.IsDeep()) {
+            bool byValue = true;
+            block.ForEach([&](const Many& subblock) {
+               byValue = IsByValue(subblock);
+               return byValue ? Loop::Continue : Loop::Break;
+            });
+            return byValue;
+         }
+
+         const auto type = block.GetType();
+         return not type or type->mIsPOD;
+      }
+
+      /// Check if a verb can be memoized - it must be pure, and its source   
+      /// and argument must be compared by value                              
+      ///   @param verb - the verb to check                                   
+      ///   @return true if verb can be memoized                              
+      bool IsMemoizable(const Verb& verb) {
+         return Memo::IsPure(verb.GetVerb())
+            and IsByValue(verb.GetSource())
+            and IsByValue(verb.GetArgument());
+      }
+
+   } // namespace Langulus::Flow::<anonymous>
+
+
+   /// Get the ratio of recalled executions                                   
+   ///   @return the hit rate in the range [0; 1]                             
+   Real Memo::Statistics::GetHitRate() const noexcept {
+      const auto total = mHits + mMisses;
+      return total ? static_cast<Real>(mHits) / total : Real {0};
+   }
+
+   /// Check if an entry remembers exactly the same inputs as a verb          
+   ///   @param verb - the verb to compare against                            
+   ///   @return true if inputs are the same                                  
+   bool Memo::Entry::Matches(const Verb& verb) const {
+      return mVerb == verb.GetVerb()
+         and mCharge == verb.GetCharge()
+         and mState == verb.GetVerbState()
+         and mSource == verb.GetSource()
+         and mArgument == verb.GetArgument();
+   }
+
+   /// Create a memoization table                                             
+   ///   @param limit - maximum number of remembered executions               
+   Memo::Memo(Count limit)
+      : mLimit {::std::max(limit, Count {1})} {}
+
+   /// Get the key for a verb - the verb hash combined with its source hash   
+   ///   @param verb - the verb to get the key of                             
+   ///   @return the key                                                      
+   Hash Memo::GetKey(const Verb& verb) {
+      return HashOf(verb.GetHash(), verb.GetSource().GetHash());
+   }
+
+   /// Recall the output of a previous execution of the same pure verb        
+   ///   @param verb - [in/out] the verb to recall; on success its output     
+   ///      and number of successes are restored                              
+   ///   @return true if verb was recalled, and doesn't need executing        
+   bool Memo::Recall(Verb& verb) {
+      if (not IsMemoizable(verb))
+         return false;
+
+      const auto found = mEntries.FindIt(GetKey(verb));
+      if (not found or not found.GetValue().Matches(verb)) {
+         ++mStatistics.mMisses;
+         return false;
+      }
+
+      auto& entry = found.GetValue();
+      verb.CompleteDispatch<false>(entry.mSuccesses, Abandon(Many {entry.mOutput}));
+      ++mStatistics.mHits;
+      return true;
+   }
+
+   /// Remember the output of a successfully executed pure verb               
+   ///   @param verb - the executed verb                                      
+   void Memo::Remember(const Verb& verb) {
+      if (not verb.IsDone() or not IsMemoizable(verb))
+         return;
+
+      // Pending asynchronous tasks can't be shared                     
+      if (verb.GetOutput().template Is<Task>())
+         return;
+
+      const auto key = GetKey(verb);
+      Entry entry {
+         verb.GetVerb(), verb.GetCharge(), verb.GetVerbState(),
+         verb.GetSource(), verb.GetArgument(), verb.GetOutput(),
+         verb.GetSuccesses()
+      };
+
+      auto found = mEntries.FindIt(key);
+      if (found) {
+         // Hash collision, or forced re-execution - just overwrite     
+         found.GetValue() = Abandon(entry);
+         return;
+      }
+
+      if (mOrder.GetCount() < mLimit)
+         mOrder << key;
+      else {
+         // Table is full, so evict the oldest entry                    
+         mEntries.RemoveKey(mOrder[mOldest]);
+         mOrder[mOldest] = key;
+         mOldest = (mOldest + 1) % mLimit;
+         ++mStatistics.mEvictions;
+      }
+
+      mEntries.Insert(key, Abandon(entry));
+   }
+
+   /// Forget all remembered executions and statistics                        
+   void Memo::Reset() {
+      mEntries.Reset();
+      mOrder.Reset();
+      mOldest = 0;
+      mStatistics = {};
+   }
+
+   /// Get the number of remembered executions                                
+   ///   @return the number of entries                                        
+   Count Memo::GetCount() const noexcept {
+      return mEntries.GetCount();
+   }
+
+   /// Get the maximum number of remembered executions                        
+   ///   @return the limit                                                    
+   Count Memo::GetLimit() const noexcept {
+      return mLimit;
+   }
+
+   /// Get the memoization statistics                                         
+   ///   @return the statistics                                               
+   auto Memo::GetStatistics() const noexcept -> const Statistics& {
+      return mStatistics;
+   }
+
+   /// Get the memoization table, installed in the current thread             
+   ///   @return the table, or nullptr if none is installed                   
+   Memo* Memo::GetActive() noexcept {
+      return Active;
+   }
+
+   /// Mark a verb as pure or impure, allowing/disallowing memoization        
+   ///   @param verb - the verb to mark                                       
+   ///   @param pure - whether or not verb is pure                            
+   void Memo::MarkPure(VMeta verb, bool pure) {
+      auto& registry = GetPureRegistry();
+      {
+         const ::std::unique_lock lock {registry.mMutex};
+         const auto found = registry.mVerbs.Find(verb);
+         if (pure and not found)
+            registry.mVerbs << verb;
+         else if (not pure and found)
+            registry.mVerbs.RemoveIndex(found);
+      }
+      PurityGeneration.fetch_add(1, ::std::memory_order_release);
+   }
+
+   /// Check if a verb is pure, and can be memoized. The registry is          
+   /// searched only the first time a verb is checked in a thread, and        
+   /// after verbs are marked pure or impure                                  
+   ///   @param verb - the verb to check                                      
+   ///   @return true if verb is pure                                         
+   bool Memo::IsPure(VMeta verb) {
+      const auto generation = PurityGeneration.load(::std::memory_order_acquire);
+      auto& entry = PurityCache[HashOf(verb).mHash & (PurityCacheSize - 1)];
+      if (entry.mGeneration == generation and entry.mVerb == verb)
+         return entry.mPure;
+
+      auto& registry = GetPureRegistry();
+      const ::std::shared_lock lock {registry.mMutex};
+      entry.mVerb = verb;
+      entry.mGeneration = generation;
+      entry.mPure = static_cast<bool>(registry.mVerbs.Find(verb));
+      return entry.mPure;
+   }
+
+   /// Install a memoization table for the current thread                     
+   ///   @param memo - the table to install, or nullptr to do nothing         
+   Memo::Scope::Scope(Memo* memo) noexcept
+      : mPrevious {Active} {
+      if (memo) {
+         Active = memo;
+         mInstalled = true;
+      }
+   }
+
+   /// Restore the previously installed table                                 
+   Memo::Scope::~Scope() {
+      if (mInstalled)
+         Active = mPrevious;
+   }
+
+} // namespace Langulus::Flow
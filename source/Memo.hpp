@@ -0,0 +1,115 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Verb.hpp"
+#include <Anyness/TMap.hpp>
+
+
+namespace Langulus::Flow
+{
+
+   ///                                                                        
+   ///   Memoization table for pure verbs                                     
+   ///                                                                        
+   ///   Remembers the outputs of successfully executed pure verbs, keyed by  
+   /// the verb hash combined with the integrated source hash, and recalls    
+   /// them instead of dispatching the same verb again. A verb is pure, if    
+   /// its output depends only on its type, charge, state, source and         
+   /// argument. Only verbs marked via MarkPure are memoized, and only if     
+   /// their source and argument contain POD data without sparse handles,     
+   /// because those are compared by value. Hash collisions are detected,     
+   /// by comparing the remembered inputs.                                    
+   ///   The table is limited in size - when full, the oldest entries are     
+   /// evicted first. Install a table for the current thread via a            
+   /// Memo::Scope, or attach it to a Temporal flow.                          
+   ///   Recalled outputs are shared with the table, so they must not be      
+   /// modified in place by whoever consumes them.                            
+   ///                                                                        
+   class Memo {
+   public:
+      /// Memoization statistics                                              
+      struct Statistics {
+         // Number of successfully recalled executions                  
+         Count mHits {};
+         // Number of pure verb executions, that weren't remembered     
+         Count mMisses {};
+         // Number of entries that were evicted due to size limits      
+         Count mEvictions {};
+
+         NOD() LANGULUS_API(FLOW) Real GetHitRate() const noexcept;
+      };
+
+      class Scope;
+
+   private:
+      /// A remembered verb execution                                         
+      struct Entry {
+         VMeta mVerb;
+         Charge mCharge;
+         VerbState mState;
+         Many mSource;
+         Many mArgument;
+         Many mOutput;
+         Count mSuccesses {};
+
+         NOD() bool Matches(const Verb&) const;
+      };
+
+      // Remembered executions                                          
+      TUnorderedMap<Hash, Entry> mEntries;
+      // Keys in order of insertion, used as a ring buffer for eviction 
+      TMany<Hash> mOrder;
+      // Index of the oldest key in mOrder                              
+      Offset mOldest {};
+      // Maximum number of remembered executions                        
+      Count mLimit;
+      // Statistics                                                     
+      Statistics mStatistics;
+
+      NOD() static Hash GetKey(const Verb&);
+
+   public:
+      LANGULUS_API(FLOW) Memo(Count limit = 1024);
+
+      LANGULUS_API(FLOW) bool Recall(Verb&);
+      LANGULUS_API(FLOW) void Remember(const Verb&);
+      LANGULUS_API(FLOW) void Reset();
+
+      NOD() LANGULUS_API(FLOW) Count GetCount() const noexcept;
+      NOD() LANGULUS_API(FLOW) Count GetLimit() const noexcept;
+      NOD() LANGULUS_API(FLOW) const Statistics& GetStatistics() const noexcept;
+
+      NOD() LANGULUS_API(FLOW) static Memo* GetActive() noexcept;
+      LANGULUS_API(FLOW) static void MarkPure(VMeta, bool = true);
+      NOD() LANGULUS_API(FLOW) static bool IsPure(VMeta);
+
+      template<CT::Verb V>
+      static void MarkPure(bool pure = true) {
+         MarkPure(MetaVerbOf<V>(), pure);
+      }
+   };
+
+
+   ///                                                                        
+   ///   Installs a memoization table for all verb executions in the current  
+   /// thread, until destroyed. Installing a null table does nothing          
+   ///                                                                        
+   class Memo::Scope {
+      Memo* mPrevious;
+      bool mInstalled {};
+
+   public:
+      Scope() = delete;
+      Scope(const Scope&) = delete;
+      Scope(Scope&&) = delete;
+
+      LANGULUS_API(FLOW) Scope(Memo*) noexcept;
+      LANGULUS_API(FLOW) ~Scope();
+   };
+
+} // namespace Langulus::Flow
@@ -0,0 +1,210 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Profiler.hpp"
+#include "Time.inl"
+#include <Anyness/TMap.hpp>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+
+namespace Langulus::Flow::Profiler
+{
+
+   ::std::atomic<bool> Enabled {false};
+
+   namespace
+   {
+
+      /// A single recorded event, exported as a chrome trace 'complete'      
+      /// event afterwards                                                    
+      struct Event {
+         VMeta mVerb;
+         Stage mStage;
+         bool mSuccess;
+         Count mDepth;
+         Offset mAllocations;
+         TimePoint mStart;
+         Time mDuration;
+         size_t mThread;
+      };
+
+      /// Events are capped, so that forgetting the profiler enabled          
+      /// doesn't eat all available memory                                    
+      constexpr Count MaxEvents = 1024 * 1024;
+
+      /// All profiler state is guarded by a single mutex - profiling is      
+      /// not free once enabled, but it must never race                       
+      ::std::mutex Guard;
+      TUnorderedMap<VMeta, Statistics> Stats[static_cast<int>(Stage::Counter)];
+      TMany<Event> Events;
+      TimePoint Origin;
+
+      /// Nesting depth of the profiled scopes in the current thread          
+      thread_local Count Depth = 0;
+
+      /// Get a readable name for a stage                                     
+      constexpr const char* StageName(Stage stage) noexcept {
+         switch (stage) {
+         case Stage::Execute:  return "Execute";
+         case Stage::Dispatch: return "Dispatch";
+         default:              return "Unknown";
+         }
+      }
+
+      /// Get a readable name for a verb                                      
+      Token VerbName(VMeta verb) noexcept {
+         return verb ? verb->mToken : Token {"<unknown>"};
+      }
+
+   } // namespace Langulus::Flow::Profiler::<anonymous>
+
+
+   /// Enable or disable profiling at runtime                                 
+   ///   @param state - true to enable profiling                              
+   void Enable(const bool state) noexcept {
+      if (state and not IsEnabled()) {
+         const ::std::scoped_lock lock {Guard};
+         if (not Origin)
+            Origin = SteadyClock::Now();
+      }
+
+      Enabled.store(state, ::std::memory_order_relaxed);
+   }
+
+   /// Clear all accumulated statistics and events                            
+   void Reset() {
+      const ::std::scoped_lock lock {Guard};
+      for (auto& stats : Stats)
+         stats.Reset();
+      Events.Reset();
+      Origin = SteadyClock::Now();
+   }
+
+   /// Get accumulated statistics for a verb                                  
+   ///   @param verb - the verb type to get statistics for                    
+   ///   @param stage - the executor stage to get statistics for              
+   ///   @return the statistics, or default statistics if verb wasn't seen    
+   Statistics GetStatistics(VMeta verb, Stage stage) {
+      const ::std::scoped_lock lock {Guard};
+      auto& stats = Stats[static_cast<int>(stage)];
+      const auto found = stats.FindIt(verb);
+      if (found)
+         return found.GetValue();
+      return {};
+   }
+
+   /// Get the current nesting depth of profiled scopes in this thread        
+   ///   @return the depth                                                    
+   Count GetDepth() noexcept {
+      return Depth;
+   }
+
+   /// Get the number of entries currently allocated by the memory manager    
+   ///   @return the number of entries, or zero if statistics are not         
+   ///      gathered by the memory manager                                    
+   Offset GetAllocations() noexcept {
+      #if LANGULUS_FEATURE(MANAGED_MEMORY) and LANGULUS_FEATURE(MEMORY_STATISTICS)
+         return static_cast<Offset>(Allocator::GetStatistics().mEntries);
+      #else
+         return 0;
+      #endif
+   }
+
+   /// Dump accumulated statistics to the log                                 
+   void Dump() {
+      const ::std::scoped_lock lock {Guard};
+      const auto tab = Logger::InfoTab("Flow profiler statistics:");
+      for (int stage = 0; stage < static_cast<int>(Stage::Counter); ++stage) {
+         for (auto pair : Stats[stage]) {
+            const auto& s = pair.mValue;
+            Logger::Info(StageName(static_cast<Stage>(stage)), ' ',
+               VerbName(pair.mKey), ": ", s.mCalls, " calls (",
+               s.mSuccesses, " succeeded, ", s.mFailures, " failed), ",
+               s.mTime, ", ", s.mAllocations, " allocations, depth ",
+               s.mMaxDepth
+            );
+         }
+      }
+   }
+
+   /// Export all recorded events as a Chrome trace JSON file, that can be    
+   /// opened with chrome://tracing or https://ui.perfetto.dev                
+   ///   @param filename - the file to write                                  
+   ///   @return true if the file was written successfully                    
+   bool ExportChromeTrace(const Token& filename) {
+      const ::std::scoped_lock lock {Guard};
+      ::std::ofstream file {::std::string {filename.data(), filename.size()}};
+      if (not file)
+         return false;
+
+      file << "{\"traceEvents\":[";
+      bool first = true;
+      for (auto& e : Events) {
+         const auto ts = ::std::chrono::duration<double, ::std::micro>(
+            e.mStart - Origin).count();
+         const auto dur = ::std::chrono::duration<double, ::std::micro>(
+            static_cast<const Time::Base&>(e.mDuration)).count();
+
+         file << (first ? "" : ",") << fmt::format(
+            "\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+            "\"dur\":{:.3f},\"pid\":0,\"tid\":{},\"args\":{{\"depth\":{},"
+            "\"success\":{},\"allocations\":{}}}}}",
+            VerbName(e.mVerb), StageName(e.mStage), ts, dur, e.mThread,
+            e.mDepth, e.mSuccess, e.mAllocations
+         );
+         first = false;
+      }
+
+      file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+      return static_cast<bool>(file);
+   }
+
+   /// Begin profiling a verb execution/dispatch in the current thread        
+   ///   @param verb - the verb type being profiled                           
+   ///   @param stage - the executor stage being profiled                     
+   Scope::Scope(VMeta verb, Stage stage)
+      : mVerb {verb}
+      , mStage {stage}
+      , mStart {SteadyClock::Now()}
+      , mAllocations {GetAllocations()} {
+      ++Depth;
+   }
+
+   /// Finish profiling, and accumulate the results                           
+   Scope::~Scope() {
+      const Time duration = SteadyClock::Now() - mStart;
+      const auto allocations = GetAllocations() - mAllocations;
+      const auto depth = Depth--;
+
+      const ::std::scoped_lock lock {Guard};
+      auto& stats = Stats[static_cast<int>(mStage)];
+      auto found = stats.FindIt(mVerb);
+      if (not found) {
+         stats.Insert(mVerb, Statistics {});
+         found = stats.FindIt(mVerb);
+      }
+
+      auto& s = found.GetValue();
+      ++s.mCalls;
+      if (mSuccess) ++s.mSuccesses;
+      else          ++s.mFailures;
+      s.mAllocations += allocations;
+      s.mTime = s.mTime + duration;
+      if (depth > s.mMaxDepth)
+         s.mMaxDepth = depth;
+
+      if (Events.GetCount() < MaxEvents) {
+         Events << Event {
+            mVerb, mStage, mSuccess, depth, allocations, mStart, duration,
+            ::std::hash<::std::thread::id> {}(::std::this_thread::get_id())
+         };
+      }
+   }
+
+} // namespace Langulus::Flow::Profiler
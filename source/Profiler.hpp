@@ -0,0 +1,100 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Time.hpp"
+#include <atomic>
+
+
+namespace Langulus::Flow::Profiler
+{
+
+   /// Stages of the executor that can be profiled                            
+   enum class Stage : uint8_t {
+      Execute,       // A full ExecuteVerb, including integration
+      Dispatch,      // A DispatchDeep call, nested for each subcontext
+      Counter
+   };
+
+   ///                                                                        
+   ///   Accumulated statistics for a single verb type and stage              
+   ///                                                                        
+   struct Statistics {
+      // Number of times the verb was executed/dispatched               
+      Count mCalls {};
+      // Number of executions that succeeded                            
+      Count mSuccesses {};
+      // Number of executions that failed                               
+      Count mFailures {};
+      // Net number of allocated entries while executing (only when     
+      // managed memory statistics are enabled, otherwise zero)         
+      Offset mAllocations {};
+      // Accumulated wall time, including nested executions             
+      Time mTime {};
+      // The deepest nesting level this verb was executed at            
+      Count mMaxDepth {};
+   };
+
+   /// Whether or not profiling is currently enabled                          
+   /// Read by the executor on each verb, so it must stay a relaxed atomic    
+   LANGULUS_API(FLOW) extern ::std::atomic<bool> Enabled;
+
+   /// Check if profiling is enabled - this is the only cost paid by the      
+   /// executor, when profiling is disabled                                   
+   ///   @return true if profiling is enabled                                 
+   LANGULUS(INLINED)
+   bool IsEnabled() noexcept {
+      return Enabled.load(::std::memory_order_relaxed);
+   }
+
+   LANGULUS_API(FLOW) void Enable(bool = true) noexcept;
+   LANGULUS_API(FLOW) void Reset();
+
+   NOD() LANGULUS_API(FLOW)
+   Statistics GetStatistics(VMeta, Stage = Stage::Execute);
+   NOD() LANGULUS_API(FLOW)
+   Count GetDepth() noexcept;
+   NOD() LANGULUS_API(FLOW)
+   Offset GetAllocations() noexcept;
+
+   LANGULUS_API(FLOW) void Dump();
+   LANGULUS_API(FLOW) bool ExportChromeTrace(const Token&);
+
+
+   ///                                                                        
+   ///   Profiling scope                                                      
+   ///                                                                        
+   /// Measures a single verb execution/dispatch in the current thread, and   
+   /// accumulates the results when destroyed. Create it only after checking  
+   /// IsEnabled(), so that disabled profiling remains a single branch        
+   ///                                                                        
+   class Scope {
+      VMeta mVerb;
+      Stage mStage;
+      bool mSuccess {};
+      TimePoint mStart;
+      Offset mAllocations;
+
+   public:
+      Scope() = delete;
+      Scope(const Scope&) = delete;
+      Scope(Scope&&) = delete;
+
+      LANGULUS_API(FLOW) Scope(VMeta, Stage);
+      LANGULUS_API(FLOW) ~Scope();
+
+      /// Mark the scope as succeeded/failed, and forward the result          
+      ///   @param result - the result of the profiled execution              
+      ///   @return the same result                                           
+      template<class T> LANGULUS(INLINED)
+      T Complete(T result) noexcept {
+         mSuccess = static_cast<bool>(result);
+         return result;
+      }
+   };
+
+} // namespace Langulus::Flow::Profiler
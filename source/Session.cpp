@@ -0,0 +1,131 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Session.hpp"
+#include <cstring>
+
+
+namespace Langulus::Flow
+{
+
+   /// Load a previously recorded log                                         
+   ///   @param bytes - the log, as returned by GetBytes                      
+   Session::Session(const Bytes& bytes)
+      : mBytes {bytes} {
+      // Count the entries, skipping their scopes                       
+      Offset at = 0;
+      while (at < mBytes.GetCount()) {
+         Event event;
+         Time::rep stamp;
+         Read(at, &event, sizeof(event));
+         Read(at, &stamp, sizeof(stamp));
+         if (event != Update) {
+            Count size;
+            Read(at, &size, sizeof(size));
+            LANGULUS_ASSERT(at + size <= mBytes.GetCount(),
+               Flow, "Truncated session log");
+            at += size;
+         }
+
+         ++mCount;
+      }
+   }
+
+   /// Append raw bytes to the log                                            
+   ///   @param data - the bytes to append                                    
+   ///   @param size - number of bytes                                        
+   void Session::Write(const void* data, Count size) {
+      const auto offset = mBytes.GetCount();
+      mBytes.New(size);
+      ::std::memcpy(mBytes.GetRaw() + offset, data, size);
+   }
+
+   /// Read raw bytes from the log                                            
+   ///   @param at - [in/out] where to read from, moved past the bytes        
+   ///   @param data - [out] where to read to                                 
+   ///   @param size - number of bytes                                        
+   void Session::Read(Offset& at, void* data, Count size) const {
+      LANGULUS_ASSERT(at + size <= mBytes.GetCount(),
+         Flow, "Truncated session log");
+      ::std::memcpy(data, mBytes.GetRaw() + at, size);
+      at += size;
+   }
+
+   /// Record an event without a scope                                        
+   ///   @param event - the event                                             
+   ///   @param stamp - the timestamp of the event                            
+   void Session::Record(Event event, Time::rep stamp) {
+      LANGULUS_ASSUME(DevAssumes, event == Update,
+         "Event requires a scope");
+      Write(&event, sizeof(event));
+      Write(&stamp, sizeof(stamp));
+      ++mCount;
+   }
+
+   /// Record an event with a scope                                           
+   ///   @attention throws if scope can't be serialized, such as sparse       
+   ///      scopes, that are handles to external data                         
+   ///   @param event - the event                                             
+   ///   @param stamp - the timestamp of the event                            
+   ///   @param scope - the scope, as it was pushed to the flow               
+   void Session::Record(Event event, Time::rep stamp, const Many& scope) {
+      LANGULUS_ASSUME(DevAssumes, event != Update,
+         "Event doesn't have a scope");
+      Bytes serialized;
+      LANGULUS_ASSERT(scope.Serialize(serialized) or not scope,
+         Flow, "Can't record a scope, that can't be serialized");
+
+      const Count size = serialized.GetCount();
+      Write(&event, sizeof(event));
+      Write(&stamp, sizeof(stamp));
+      Write(&size, sizeof(size));
+      Write(serialized.GetRaw(), size);
+      ++mCount;
+   }
+
+   /// Read an entry from the log                                             
+   ///   @attention throws if the scope of the entry can't be deserialized    
+   ///   @param at - offset of the entry, zero for the first one              
+   ///   @param entry - [out] the entry                                       
+   ///   @return the offset of the next entry, or the size of the log, if     
+   ///      this was the last entry                                           
+   Offset Session::Read(Offset at, Entry& entry) const {
+      Read(at, &entry.mEvent, sizeof(entry.mEvent));
+      Read(at, &entry.mStamp, sizeof(entry.mStamp));
+      entry.mScope.Reset();
+      if (entry.mEvent == Update)
+         return at;
+
+      Count size;
+      Read(at, &size, sizeof(size));
+      Bytes serialized;
+      serialized.New(size);
+      Read(at, serialized.GetRaw(), size);
+      LANGULUS_ASSERT(serialized.Deserialize(entry.mScope) or not size,
+         Flow, "Can't deserialize a recorded scope");
+      return at;
+   }
+
+   /// Clear the log                                                          
+   void Session::Clear() {
+      mBytes.Reset();
+      mCount = 0;
+   }
+
+   /// Get the binary log, so that it can be saved                            
+   ///   @return the log                                                      
+   const Bytes& Session::GetBytes() const noexcept {
+      return mBytes;
+   }
+
+   /// Get the number of recorded entries                                     
+   ///   @return the number of entries                                        
+   Count Session::GetCount() const noexcept {
+      return mCount;
+   }
+
+} // namespace Langulus::Flow
@@ -0,0 +1,73 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "Time.hpp"
+#include <Anyness/Serial.hpp>
+
+
+namespace Langulus::Flow
+{
+
+   ///                                                                        
+   ///   Binary session log                                                   
+   ///                                                                        
+   ///   Records everything that changes a Temporal flow from the outside -   
+   /// pushed scopes, scopes linked from the queue, and updates - in the      
+   /// order they happened, so that Temporal::Replay can reproduce the        
+   /// session deterministically. Scopes are stored in the binary form        
+   /// produced by Anyness serialization, instead of code, so recording is    
+   /// cheap enough to be left on. Attach a log to a flow via                 
+   /// Temporal::SetSession, and save or load it via GetBytes.                
+   ///   Each entry is an event byte, followed by a timestamp, and then by    
+   /// the byte count and bytes of the scope, if event has one. Numbers are   
+   /// stored in native byte order.                                           
+   ///                                                                        
+   class Session {
+   public:
+      /// Events that can be recorded                                         
+      enum Event : uint8_t {
+         Update,     // Flow was updated, timestamp is the delta time
+         Push,       // A scope was pushed, timestamp is the flow time
+         Batch,      // Scopes were pushed at once via PushBatch
+         Link        // Enqueued scopes were linked in an Update
+      };
+
+      /// A single recorded event                                             
+      struct Entry {
+         Event mEvent;
+         // Delta time for updates, or the flow time for anything else  
+         Time::rep mStamp {};
+         // The deserialized scope, if any                              
+         Many mScope;
+      };
+
+   private:
+      // The binary log                                                 
+      Bytes mBytes;
+      // Number of recorded entries                                     
+      Count mCount {};
+
+      void Write(const void*, Count);
+      void Read(Offset&, void*, Count) const;
+
+   public:
+      Session() = default;
+      LANGULUS_API(FLOW) Session(const Bytes&);
+
+      LANGULUS_API(FLOW) void Record(Event, Time::rep);
+      LANGULUS_API(FLOW) void Record(Event, Time::rep, const Many&);
+      LANGULUS_API(FLOW) Offset Read(Offset, Entry&) const;
+      LANGULUS_API(FLOW) void Clear();
+
+      NOD() LANGULUS_API(FLOW)
+      const Bytes& GetBytes() const noexcept;
+      NOD() LANGULUS_API(FLOW)
+      Count GetCount() const noexcept;
+   };
+
+} // namespace Langulus::Flow
@@ -109,6 +109,17 @@ namespace Langulus::Flow
       VERB& operator <<= (CT::UnfoldInsertable auto&&);
       VERB& operator >>= (CT::UnfoldInsertable auto&&);
 
+      ///                                                                     
+      ///   Static dispatch                                                   
+      ///                                                                     
+      template<CT::Dense T>
+      static bool DispatchMutable(void*, Verb&);
+      template<CT::Dense T>
+      static bool DispatchConstant(const void*, Verb&);
+
+      template<CT::Dense...TN>
+      static void RegisterDispatch();
+
    private:
       // Functionality graveyard                                        
       using Verb::SetVerb;
@@ -8,6 +8,7 @@
 #pragma once
 #include "TVerb.hpp"
 #include "Verb.inl"
+#include "inner/Dispatch.hpp"
 
 #define TEMPLATE()   template<class VERB>
 #define TME()        TVerb<VERB>
@@ -241,6 +242,77 @@ namespace Langulus::Flow
       return Verb::operator >>= <VERB>(Forward<T>(rhs));
    }
 
+   /// Trampoline, that executes the verb in a mutable type-erased context,   
+   /// using the statically optimized routine. If T reflects an overload of   
+   /// the verb for the specific argument type, that overload is used instead 
+   ///   @tparam T - the type of the context                                  
+   ///   @param context - pointer to the context                              
+   ///   @param verb - the verb to execute                                    
+   ///   @return true if verb was executed                                    
+   TEMPLATE() template<CT::Dense T>
+   bool TME()::DispatchMutable(void* context, Verb& verb) {
+      if (verb.GetType()) {
+         const auto type = MetaDataOf<T>();
+         const auto overload = Inner::FindAbilityMutable(
+            type, verb.GetVerb(), verb.GetType());
+         if (overload and overload != Inner::FindAbilityMutable(
+            type, verb.GetVerb(), DMeta {})) {
+            overload(context, verb);
+            return verb.IsDone();
+         }
+      }
+
+      return VERB::ExecuteIn(*static_cast<T*>(context), verb);
+   }
+
+   /// Trampoline, that executes the verb in a constant type-erased context,  
+   /// using the statically optimized routine. If T reflects an overload of   
+   /// the verb for the specific argument type, that overload is used instead 
+   ///   @tparam T - the type of the context                                  
+   ///   @param context - pointer to the context                              
+   ///   @param verb - the verb to execute                                    
+   ///   @return true if verb was executed                                    
+   TEMPLATE() template<CT::Dense T>
+   bool TME()::DispatchConstant(const void* context, Verb& verb) {
+      if (verb.GetType()) {
+         const auto type = MetaDataOf<T>();
+         const auto overload = Inner::FindAbilityConstant(
+            type, verb.GetVerb(), verb.GetType());
+         if (overload and overload != Inner::FindAbilityConstant(
+            type, verb.GetVerb(), DMeta {})) {
+            overload(context, verb);
+            return verb.IsDone();
+         }
+      }
+
+      return VERB::ExecuteIn(*static_cast<const T*>(context), verb);
+   }
+
+   /// Generate trampolines for each of the provided types, and register      
+   /// them in the static dispatch tables. Runtime dispatch of this verb in   
+   /// these types then becomes a two-level array lookup, instead of an       
+   /// ability search via RTTI - the trampolines take precedence over the     
+   /// reflected abilities, and resolve argument overloads by themselves      
+   ///   @tparam TN - the types to register                                   
+   TEMPLATE() template<CT::Dense...TN>
+   void TME()::RegisterDispatch() {
+      const auto generate = []<class T>() {
+         Inner::TrampolineMutable mutableTrampoline {};
+         Inner::TrampolineConstant constantTrampoline {};
+         if constexpr (VERB::template AvailableFor<T>())
+            mutableTrampoline = &DispatchMutable<T>;
+         if constexpr (VERB::template AvailableFor<const T>())
+            constantTrampoline = &DispatchConstant<T>;
+
+         if (mutableTrampoline or constantTrampoline) {
+            Inner::RegisterTrampoline(MetaDataOf<T>(), MetaVerbOf<VERB>(),
+               mutableTrampoline, constantTrampoline);
+         }
+      };
+
+      (generate.template operator() <TN> (), ...);
+   }
+
 } // namespace Langulus::Flow
 
 #undef TME
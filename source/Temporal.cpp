@@ -10,7 +10,11 @@
 #include "Resolvable.inl"
 #include "inner/Missing.hpp"
 #include "inner/Fork.hpp"
+#include "inner/Workers.hpp"
+#include "Async.hpp"
 #include "Temporal.hpp"
+#include <algorithm>
+#include <cmath>
 
 #if 0
    #define VERBOSE_TEMPORAL(...)       Logger::Verbose(*this, ": ", __VA_ARGS__)
@@ -20,8 +24,36 @@
    #define VERBOSE_TEMPORAL_TAB(...)   LANGULUS(NOOP)
 #endif
 
+#define TEMPORAL_ERRORS(...)  Logger::Error(*this, ": ", __VA_ARGS__)
+
 using namespace Langulus::Flow;
 
+namespace
+{
+   /// Ordering for the min-heap of periodic flow deadlines                   
+   constexpr auto Later = [](const auto& lhs, const auto& rhs) noexcept {
+      return lhs.mTime > rhs.mTime;
+   };
+
+   /// Number of periods the executing periodic flow accounts for             
+   thread_local Count ActiveTicks = 1;
+
+   /// Find a sub-flow by its key, or insert an empty one, if missing         
+   ///   @param stack - the stack to search in                                
+   ///   @param key - the key of the sub-flow                                 
+   ///   @param parent - the parent of the sub-flow, if inserted              
+   ///   @return the sub-flow                                                 
+   template<class STACK>
+   Temporal& GetOrInsert(STACK& stack, Temporal::Stamp key, Temporal* parent) {
+      auto found = stack.FindIt(key);
+      if (found)
+         return found.GetValue();
+
+      stack.Insert(key, parent);
+      return stack.FindIt(key).GetValue();
+   }
+}
+
 
 /// Default constructor, add the initial missing future point                 
 ///   @param environment - the initial flow environment                       
@@ -49,47 +81,20 @@ Temporal::operator Text() const {
 
 /// Reset progress for the priority stack                                     
 void Temporal::Reset() {
+   // Deadlines are measured in uptime, so shift them along with it     
+   // Shifting all of them by the same amount preserves the heap        
+   const auto uptime = GetUptime();
+   for (auto& deadline : mSchedule)
+      deadline.mTime = deadline.mTime - uptime;
+
+   // Periodic flows are reset on each tick, and then executed right    
+   // away, so the progress they retain between ticks is the same       
    mStart = mNow = {};
-   ResetInner(mPriorityStack);
-}
-
-/// Reset progress for all verbs inside a scope                               
-///   @param scope - scope to reset                                           
-void Temporal::ResetInner(Many& scope) {
-   scope.ForEach(
-      [&](Many& m) {
-         if (m.IsDense())
-            ResetInner(m);
-      },
-      [&](Inner::Missing& missing) {
-         if (missing.mContent.IsDense())
-            ResetInner(missing.mContent);
-      },
-      [&](Trait& trait) {
-         if (trait.IsDense())
-            ResetInner(static_cast<Many&>(trait));
-      },
-      [&](Construct& construct) {
-         ResetInner(construct.GetDescriptor());
-      },
-      [&](Neat& neat) {
-         neat.ForEachTrait([this](Trait& trait) {
-            ResetInner(static_cast<Many&>(trait));
-         });
-         neat.ForEachConstruct([this](Construct& con) {
-            Many wrapper {con};
-            ResetInner(wrapper);
-         });
-         neat.ForEachTail([this](Many& stuff) {
-            ResetInner(stuff);
-         });
-      },
-      [&](A::Verb& constVerb) {
-         ResetInner(constVerb.GetSource());
-         ResetInner(constVerb.GetArgument());
-         constVerb.Undo();
-      }
-   );
+   if (not mPeriodic)
+      ++mProgress;
+   mSuspended = false;
+   mSuspendedOutput.Reset();
+   ResetProgress(mPriorityStack);
 }
 
 /// Compare two flows                                                         
@@ -98,13 +103,14 @@ void Temporal::ResetInner(Many& scope) {
 bool Temporal::operator == (const Temporal& other) const {
    return mFrequencyStack == other.mFrequencyStack
       and mTimeStack == other.mTimeStack
+      and mCompletedStack == other.mCompletedStack
       and mPriorityStack == other.mPriorityStack;
 }
 
 /// Check if flow contains anything                                           
 ///   @return true if flow contains something                                 
 bool Temporal::IsValid() const {
-   return mPriorityStack or mTimeStack or mFrequencyStack;
+   return mPriorityStack or mTimeStack or mFrequencyStack or mCompletedStack;
 }
 
 /// Dump the contents of the flow to the log in a pretty, colorized and       
@@ -116,6 +122,8 @@ void Temporal::Dump() const {
       Logger::Verbose(mTimeStack);
    if (mFrequencyStack)
       Logger::Verbose(mFrequencyStack);
+   if (mCompletedStack)
+      Logger::Verbose(mCompletedStack);
 }
 
 /// Get the accumulated running time across all Updates                       
@@ -124,18 +132,335 @@ Langulus::Time Temporal::GetUptime() const {
    return mNow - mStart;
 }
 
+/// Convert a time charge to a key in the time stack                          
+///   @param time - the charge, in units of mTimePeriod                       
+///   @return the key, i.e. the uptime in steady clock units                  
+auto Temporal::GetTimeStamp(Real time) const noexcept -> Stamp {
+   return static_cast<Stamp>(::std::llround(mTimePeriod.count() * time));
+}
+
+/// Convert a rate charge to a key in the frequency stack. Rates that are     
+/// closer than a steady clock unit end up in the same periodic flow          
+///   @param rate - the charge, in units of mRatePeriod                       
+///   @return the key, i.e. the period in steady clock units, never zero      
+auto Temporal::GetRateStamp(Real rate) const noexcept -> Stamp {
+   const auto period = ::std::llround(mRatePeriod.count() * rate);
+   return ::std::max(static_cast<Stamp>(period), Stamp {1});
+}
+
+/// Schedule the first execution of a periodic flow, that is about to be      
+/// inserted in the frequency stack                                           
+///   @attention assumes the period isn't scheduled yet                       
+///   @param period - the key of the periodic flow in the frequency stack     
+///   @param flow - the periodic flow                                         
+void Temporal::Schedule(Stamp period, Temporal& flow) {
+   // Periodic flows inherit the catch-up policy of their parent        
+   flow.mPeriodic = true;
+   flow.mCatchUp = mCatchUp;
+   Schedule(period, Time {period});
+}
+
+/// Schedule the next execution of a periodic flow, that is about to be       
+/// inserted in the frequency stack, keeping its policy as it is              
+///   @attention assumes the period isn't scheduled yet                       
+///   @param period - the key of the periodic flow in the frequency stack     
+///   @param left - the time left until its next execution                    
+void Temporal::Schedule(Stamp period, Time left) {
+   mSchedule << Deadline {GetUptime() + left, period};
+   ::std::push_heap(mSchedule.GetRaw(), mSchedule.GetRaw() + mSchedule.GetCount(), Later);
+}
+
+/// Index the time left until the next execution of each periodic flow,       
+/// so that merges don't search the schedule once per periodic flow           
+///   @return the time left, keyed by the period of each periodic flow        
+auto Temporal::GetTimesLeft() const -> TUnorderedMap<Stamp, Time> {
+   TUnorderedMap<Stamp, Time> result;
+   const auto uptime = GetUptime();
+   for (auto& deadline : mSchedule)
+      result.Insert(deadline.mPeriod, deadline.mTime - uptime);
+   return result;
+}
+
+/// Schedule a periodic flow, that is merged from another flow, keeping the   
+/// time left until its next execution                                        
+///   @param period - the key of the periodic flow in the frequency stack     
+///   @param left - the time left in the other flow, see GetTimesLeft         
+void Temporal::Reschedule(Stamp period, const TUnorderedMap<Stamp, Time>& left) {
+   const auto found = left.FindIt(period);
+   Schedule(period, found ? found.GetValue() : Time {period});
+}
+
+/// Point all sub-flows to this flow, and their sub-flows to them, because    
+/// moving flows around leaves their sub-flows pointing to the old place      
+void Temporal::Reparent() {
+   const auto reparent = [this](auto& stack) {
+      for (auto pair : stack) {
+         pair.mValue.mParent = this;
+         pair.mValue.Reparent();
+      }
+   };
+
+   reparent(mTimeStack);
+   reparent(mFrequencyStack);
+   reparent(mCompletedStack);
+}
+
+/// Get the time point at the given uptime, inserting it, if missing          
+///   @param time - the key of the time point                                 
+///   @return the time point                                                  
+Temporal& Temporal::GetOrInsertTime(Stamp time) {
+   return GetOrInsert(mTimeStack, time, this);
+}
+
+/// Get the periodic flow with the given period, inserting and scheduling     
+/// it, if missing                                                            
+///   @param period - the key of the periodic flow                            
+///   @return the periodic flow                                               
+Temporal& Temporal::GetOrInsertRate(Stamp period) {
+   auto found = mFrequencyStack.FindIt(period);
+   if (found)
+      return found.GetValue();
+
+   Temporal flow {this};
+   Schedule(period, flow);
+   mFrequencyStack.Insert(period, Abandon(flow));
+   return mFrequencyStack.FindIt(period).GetValue();
+}
+
+/// Check if a time point has nothing left to execute, so that it can be      
+/// moved to the completed stack and no longer updated                        
+///   @return true if the flow is complete, and has no timed or periodic      
+///      flows inside                                                         
+bool Temporal::IsRetired() const noexcept {
+   return not mSuspended and not mTimeStack and not mFrequencyStack;
+}
+
+/// Check if the flow can be updated in another thread, while its siblings    
+/// are updated in others - all verbs inside must be thread-safe, and no      
+/// block inside can be referenced from outside the flow, because reference   
+/// counts aren't atomic                                                      
+///   @return true if flow and all its sub-flows are thread-safe              
+bool Temporal::IsThreadSafe() const {
+   // Memoization tables and sessions might be shared between flows     
+   if (mMemo or mSession)
+      return false;
+
+   if (not Inner::IsThreadSafeFlow(mPriorityStack, true)
+   or  not Inner::IsThreadSafeFlow(mSuspendedOutput, true))
+      return false;
+
+   for (auto pair : mTimeStack) {
+      if (not pair.mValue.IsThreadSafe())
+         return false;
+   }
+
+   for (auto pair : mFrequencyStack) {
+      if (not pair.mValue.IsThreadSafe())
+         return false;
+   }
+   return true;
+}
+
+/// Set the catch-up policy for all periodic flows, including the ones that   
+/// will be created in the future                                             
+///   @param policy - the policy                                              
+void Temporal::SetCatchUp(const CatchUp& policy) {
+   mCatchUp = policy;
+   for (auto pair : mFrequencyStack)
+      pair.mValue.SetCatchUp(policy);
+}
+
+/// Set the catch-up policy for the periodic flow of a given rate             
+/// The periodic flow is created, if it doesn't exist yet                     
+///   @param rate - the rate of the periodic flow                             
+///   @param policy - the policy                                              
+void Temporal::SetCatchUp(Real rate, const CatchUp& policy) {
+   GetOrInsertRate(GetRateStamp(rate)).SetCatchUp(policy);
+}
+
+/// Get the catch-up policy for the periodic flow of a given rate             
+///   @param rate - the rate of the periodic flow                             
+///   @return the policy, or the one new periodic flows will get, if there's  
+///      no periodic flow with that rate                                      
+CatchUp Temporal::GetCatchUp(Real rate) const {
+   const auto found = mFrequencyStack.FindIt(GetRateStamp(rate));
+   return found ? found.GetValue().mCatchUp : mCatchUp;
+}
+
+/// Get the number of periods, the periodic flow that is currently executing  
+/// in this thread accounts for. It is always one, unless missed periods are  
+/// coalesced into a single execution                                         
+///   @return the number of periods                                           
+Count Temporal::GetTicks() noexcept {
+   return ActiveTicks;
+}
+
+/// Update independent sub-flows, i.e. periodic flows and time points, in     
+/// parallel on the worker pool. Side effects of each sub-flow are gathered   
+/// separately, and merged in the order of their keys, so they are the same   
+/// on each run. Each sub-flow gets an equal share of the active budget.      
+/// Sub-flows are still updated one by one while a memoization table is       
+/// active, or if any of them isn't thread-safe - see IsThreadSafe            
+///   @attention enable only if verbs in different sub-flows never touch      
+///      the same data                                                        
+///   @param parallel - whether or not to update sub-flows in parallel        
+void Temporal::SetParallel(bool parallel) noexcept {
+   mParallel = parallel;
+}
+
+/// Check if sub-flows are updated in parallel                                
+///   @return true if sub-flows are updated in parallel                       
+bool Temporal::IsParallel() const noexcept {
+   return mParallel;
+}
+
+/// Limit the verbs/time a single Update is allowed to consume                
+/// Sub-flows are always updated with the budget of their parents             
+///   @param budget - the budget, default-initialize to remove limits         
+void Temporal::SetBudget(const Budget& budget) noexcept {
+   mBudget = budget;
+}
+
+/// Get the budget for a single Update                                        
+///   @return the budget                                                      
+const Budget& Temporal::GetBudget() const noexcept {
+   return mBudget;
+}
+
+/// Check if priority stack execution ran out of budget, or is waiting for    
+/// asynchronous verbs, and will be resumed on next Update                    
+///   @return true if flow is suspended                                       
+bool Temporal::IsSuspended() const noexcept {
+   return mSuspended;
+}
+
+/// Attach a memoization table, that will be used for pure verbs on each      
+/// Update, unless a parent flow already installed one                        
+///   @attention the table is not owned, and must outlive the flow            
+///   @param memo - the table, or nullptr to disable memoization              
+void Temporal::SetMemo(Memo* memo) noexcept {
+   mMemo = memo;
+}
+
+/// Get the attached memoization table                                        
+///   @return the table, or nullptr if none is attached                       
+Memo* Temporal::GetMemo() const noexcept {
+   return mMemo;
+}
+
+/// Record the session in a binary log - every scope pushed to this flow,     
+/// and every Update, until detached                                          
+///   @attention the log is not owned, and must outlive the flow              
+///   @param session - the log, or nullptr to stop recording                  
+void Temporal::SetSession(Session* session) noexcept {
+   mSession = session;
+}
+
+/// Get the log, where the session is being recorded                          
+///   @return the log, or nullptr if not recording                            
+Session* Temporal::GetSession() const noexcept {
+   return mSession;
+}
+
+/// Replay a recorded session, by pushing the same scopes and doing the same  
+/// updates in the same order. The flow has to be in the state it was, when   
+/// recording started - restore a snapshot captured at that time, or start    
+/// with a new flow, if recording started with one                            
+///   @param session - the log to replay                                      
+///   @return the side effects of the whole session                           
+Many Temporal::Replay(const Session& session) {
+   LANGULUS_ASSUME(DevAssumes, &session != mSession,
+      "Can't replay a session, while recording it");
+
+   Many sideffects;
+   Session::Entry entry;
+   Offset at = 0;
+   while (at < session.GetBytes().GetCount()) {
+      at = session.Read(at, entry);
+      if (entry.mEvent == Session::Update) {
+         Update(Time {entry.mStamp}, sideffects);
+         continue;
+      }
+
+      LANGULUS_ASSERT(entry.mStamp == mNow.count(),
+         Flow, "Replay diverged from the recorded session");
+
+      switch (entry.mEvent) {
+      case Session::Push:
+         sideffects.SmartPush(IndexBack, PushInner(Abandon(entry.mScope)));
+         break;
+      case Session::Batch:
+         sideffects.SmartPush(IndexBack, PushBatch(entry.mScope));
+         break;
+      default:
+         // Linked on the next Update, just like they were originally   
+         if (entry.mScope.IsDeep() and entry.mScope.IsDense()) {
+            entry.mScope.ForEach([&](const Many& scope) {
+               mQueue.Push(Many {scope});
+            });
+         }
+         else mQueue.Push(Abandon(entry.mScope));
+      }
+   }
+
+   return Abandon(sideffects);
+}
+
 /// Advance the flow - moves time forward, executes stacks                    
 ///   @param dt - delta time                                                  
 ///   @param sideffects - any side effects produced by executing              
 ///   @return true if no exit was requested                                   
 bool Temporal::Update(Time dt, Many& sideffects) {
-   if (mStart == mNow) {
-      // We're at the beginning of time - execute the priority stack    
+   const bool result = Advance(dt, sideffects);
+   if (mSession)
+      mSession->Record(Session::Update, dt.count());
+   return result;
+}
+
+/// Advance the flow without recording it - Update is recorded only when      
+/// invoked from the outside, not when pushing scopes                         
+///   @param dt - delta time                                                  
+///   @param sideffects - any side effects produced by executing              
+///   @return true if no exit was requested                                   
+bool Temporal::Advance(Time dt, Many& sideffects) {
+   // Install the execution budget and memoization table, unless a      
+   // parent flow already did, and allow asynchronous verbs to park,    
+   // since we're going to resume them on the following updates         
+   const Budget::Scope budget {mBudget};
+   const Task::Driver driver;
+   const Memo::Scope memo {mMemo and not Memo::GetActive() ? mMemo : nullptr};
+
+   // Periodic flows reuse the outputs of their stable verbs on each    
+   // tick, any other flow executes its verbs only once anyways         
+   const Inner::Incremental::Scope incremental {
+      mPeriodic ? &mIncremental : nullptr};
+
+   // Link anything that was enqueued from other threads                
+   if (not mQueue.IsEmpty())
+      LinkQueued();
+
+   if (mSuspended or mStart == mNow) {
+      // We're at the beginning of time, or resuming a priority stack   
+      // that ran out of budget, or is waiting for asynchronous verbs   
       VERBOSE_TEMPORAL(Logger::Purple,
          "Flow before execution: ", mPriorityStack);
 
+      // Execution might get suspended, so gather outputs in the        
+      // resumable frame, and release them only when complete           
       Many unusedContext;
-      Execute(mPriorityStack, unusedContext, sideffects, false);
+      const auto parked = Task::GetParkedCount();
+      {
+         // Report only suspensions of this flow, not of its siblings   
+         const Budget::Frame frame;
+         Execute(mPriorityStack, unusedContext, mSuspendedOutput, false);
+         mSuspended = Budget::IsSuspended() or parked != Task::GetParkedCount();
+      }
+      if (mSuspended or not mPeriodic)
+         ++mProgress;
+      if (not mSuspended) {
+         sideffects.SmartPush(IndexBack, Abandon(mSuspendedOutput));
+         mSuspendedOutput.Reset();
+      }
 
       VERBOSE_TEMPORAL(Logger::Purple,
          "Flow after execution: ", mPriorityStack);
@@ -148,67 +473,398 @@ bool Temporal::Update(Time dt, Many& sideffects) {
    // Advance the global cycler for the flow                            
    mNow += dt;
 
-   // Execute flows that occur periodically                             
-   for (auto pair : mFrequencyStack) {
-      pair.mValue.mNow += dt;
-      auto ticks = pair.mValue.GetUptime().Seconds() / mRatePeriod.Seconds();
-
-      while (ticks >= pair.mKey) {
-         // Time to execute the periodic flow                           
-         pair.mValue.Reset();
-         pair.mValue.Update({}, sideffects);
-         ticks -= pair.mKey;
+   // Workers can't share the budget of this thread, so what's left of  
+   // it is split between the sub-flows. Memoized outputs are shared    
+   // with the table, so nothing is updated in parallel while one is    
+   // active                                                            
+   Budget remaining;
+   const bool parallel = mParallel and not Memo::GetActive()
+      and Budget::GetRemaining(remaining);
+
+   // Get the share of each of a number of sub-flows, updated in        
+   // parallel - false if there isn't enough for each to get a verb     
+   const auto split = [&remaining](Count count, Budget& share) {
+      share = remaining;
+      if (remaining.mVerbs) {
+         share.mVerbs = remaining.mVerbs / count;
+         return share.mVerbs > 0;
       }
+      return true;
+   };
+   Budget share;
+
+   // Execute flows that occur periodically, but only the ones that are 
+   // due - pop them to the back of the heap, earliest deadline last    
+   const auto uptime = GetUptime();
+   const auto first = mSchedule.GetRaw();
+   const auto last = first + mSchedule.GetCount();
+   auto due = last;
+   while (due != first and first->mTime <= uptime)
+      ::std::pop_heap(first, due--, Later);
+
+   if (parallel and last - due > 1
+   and split(static_cast<Count>(last - due), share)
+   and ::std::all_of(due, last, [this](const Deadline& deadline) {
+      return mFrequencyStack.FindIt(deadline.mPeriod).GetValue().IsThreadSafe();
+   })) {
+      // Execute the due periodic flows in parallel, each with its own  
+      // side effects, merged in the order of their periods afterwards  
+      ::std::sort(due, last, [](const auto& lhs, const auto& rhs) {
+         return lhs.mPeriod < rhs.mPeriod;
+      });
+
+      const auto count = static_cast<Count>(last - due);
+      TMany<Many> buffers;
+      buffers.New(count);
+      Inner::ParallelFor(count, 1, [&](Count from, Count to) {
+         for (auto i = from; i < to; ++i) {
+            const Budget::Share budget {share};
+            UpdatePeriodic(due[i], uptime, buffers[i]);
+         }
+      });
 
-      // Make sure any leftover time is returned to the periodic flow   
-      pair.mValue.mNow = pair.mValue.mStart + mRatePeriod * ticks;
+      for (auto& buffer : buffers)
+         sideffects.SmartPush(IndexBack, Abandon(buffer));
    }
+   else for (auto deadline = last; deadline != due;)
+      UpdatePeriodic(*--deadline, uptime, sideffects);
+
+   // Push the executed deadlines back in the heap                      
+   while (due != last)
+      ::std::push_heap(first, ++due, Later);
 
    // Execute flows that occur after a given point in time              
-   const auto ticks = GetUptime().Seconds() / mTimePeriod.Seconds();
-   for (auto pair : mTimeStack) {
-      if (pair.mKey > ticks) {
+   const auto now = uptime.count();
+   TMany<Stamp> retired;
+   // Gather the due time points, the time stack is sorted, so they     
+   // are all at the front                                              
+   TMany<Temporal*> points;
+   if (parallel) {
+      for (auto pair : mTimeStack) {
+         if (pair.mKey > now)
+            break;
+         points << &pair.mValue;
+      }
+
+      bool safe = points.GetCount() > 1 and split(points.GetCount(), share);
+      for (auto point : points) {
+         if (not safe)
+            break;
+         safe = point->IsThreadSafe();
+      }
+
+      if (not safe)
+         points.Reset();
+   }
+
+   if (points) {
+      // Update them in parallel, each with its own side effects        
+      TMany<Many> buffers;
+      buffers.New(points.GetCount());
+      Inner::ParallelFor(points.GetCount(), 1, [&](Count from, Count to) {
+         for (auto i = from; i < to; ++i) {
+            const Budget::Share budget {share};
+            points[i]->Advance(dt, buffers[i]);
+         }
+      });
+
+      // Merge the side effects in the order of the time points         
+      Offset index = 0;
+      for (auto pair : mTimeStack) {
+         if (index == points.GetCount())
+            break;
+
+         sideffects.SmartPush(IndexBack, Abandon(buffers[index++]));
+         if (pair.mValue.IsRetired())
+            retired << pair.mKey;
+      }
+   }
+   else for (auto pair : mTimeStack) {
+      if (pair.mKey > now) {
          // The time stack is sorted, so no point in continuing         
          break;
       }
 
       // Always update all time points before the tick count            
       // They might have periodic flows inside                          
-      pair.mValue.Update(dt, sideffects);
+      pair.mValue.Advance(dt, sideffects);
+      if (pair.mValue.IsRetired())
+         retired << pair.mKey;
+   }
+
+   // Move the time points that are done to the completed stack, so     
+   // that they are never updated again                                 
+   for (auto key : retired) {
+      auto& point = mTimeStack.FindIt(key).GetValue();
+      auto found = mCompletedStack.FindIt(key);
+      if (found)
+         found.GetValue().Merge(::std::move(point));
+      else
+         mCompletedStack.Insert(key, Abandon(point));
+      mTimeStack.RemoveKey(key);
    }
 
    return true;
 }
 
+/// Execute a periodic flow that is due, as many times as its catch-up        
+/// policy allows, and schedule its next execution                            
+///   @param deadline - [in/out] the deadline of the periodic flow            
+///   @param uptime - the current uptime of this flow                         
+///   @param sideffects - [out] any side effects produced by executing        
+void Temporal::UpdatePeriodic(
+   Deadline& deadline, const Time uptime, Many& sideffects
+) {
+   auto& flow = mFrequencyStack.FindIt(deadline.mPeriod).GetValue();
+   const Time period {deadline.mPeriod};
+
+   // Periodic flows aren't touched until they are due, so catch up     
+   // with the time that passed since their last execution              
+   flow.mNow = flow.mStart + (uptime - (deadline.mTime - period));
+   Time elapsed = flow.GetUptime();
+
+   const auto& policy = flow.mCatchUp;
+   Count executions = 0;
+   while (elapsed >= period) {
+      if (policy.mMode == CatchUp::Cap
+      and executions >= ::std::max(policy.mLimit, Count {1})) {
+         // Executed enough times, drop the missed periods, but keep    
+         // the phase of the periodic flow                              
+         elapsed = elapsed % period;
+         break;
+      }
+
+      // Coalesced and dropped executions account for all missed        
+      // periods at once                                                
+      Count periods = 1;
+      if (policy.mMode == CatchUp::Coalesce
+      or  policy.mMode == CatchUp::Drop)
+         periods = static_cast<Count>(elapsed / period);
+
+      // Time to execute the periodic flow, unless we're resuming a     
+      // suspended one. Resetting only marks verbs as not done - the    
+      // stable ones will reuse their outputs from the last tick        
+      if (not flow.mSuspended)
+         flow.Reset();
+
+      const auto previousTicks = ActiveTicks;
+      ActiveTicks = policy.mMode == CatchUp::Coalesce ? periods : 1;
+      flow.Advance({}, sideffects);
+      ActiveTicks = previousTicks;
+
+      if (flow.mSuspended) {
+         // Out of budget, leftover time will be consumed on the next   
+         // Update                                                      
+         break;
+      }
+
+      ++executions;
+      if (policy.mMode == CatchUp::Drop) {
+         // Restart the period from this execution                      
+         elapsed = {};
+         break;
+      }
+
+      elapsed = elapsed - period * periods;
+   }
+
+   // Make sure any leftover time is returned to the periodic flow, and 
+   // schedule its next execution. Suspended flows are resumed on the   
+   // next Update                                                       
+   flow.mNow = flow.mStart + elapsed;
+   deadline.mTime = flow.mSuspended
+      ? uptime : uptime + (period - elapsed);
+}
+
 /// Merge a flow                                                              
 ///   @param other - the flow to merge with this one                          
 void Temporal::Merge(const Temporal& other) {
+   // The priority stack changes, so cached outputs are no longer valid 
+   mIncremental.Reset();
+   ++mGeneration;
+
    // Concatenate priority stacks                                       
    mPriorityStack += other.mPriorityStack;
 
    // Merge time stacks                                                 
-   for (auto pair : other.mTimeStack) {
-      auto found = mTimeStack.FindIt(pair.mKey);
-      if (not found) {
-         // New time point required                                     
-         mTimeStack.Insert(pair.mKey, this);
-         found = mTimeStack.FindIt(pair.mKey);
+   for (auto pair : other.mTimeStack)
+      GetOrInsertTime(pair.mKey).Merge(pair.mValue);
+
+   // Merge frequency stacks, periodic flows that are missing here keep 
+   // their catch-up policy and the time left until their execution     
+   const auto left = other.GetTimesLeft();
+   for (auto pair : other.mFrequencyStack) {
+      auto found = mFrequencyStack.FindIt(pair.mKey);
+      if (found) {
+         found.GetValue().Merge(pair.mValue);
+         continue;
       }
 
-      found.GetValue().Merge(pair.mValue);
+      Temporal flow {this};
+      flow.mPeriodic = true;
+      flow.mCatchUp = pair.mValue.mCatchUp;
+      flow.Merge(pair.mValue);
+      Reschedule(pair.mKey, left);
+      mFrequencyStack.Insert(pair.mKey, Abandon(flow));
+   }
+
+   // Merge completed time points                                       
+   for (auto pair : other.mCompletedStack)
+      GetOrInsert(mCompletedStack, pair.mKey, this).Merge(pair.mValue);
+
+   // Inserted sub-flows, and any sub-flows relocated by the            
+   // insertions, still point to their old parents                      
+   Reparent();
+}
+
+/// Merge a flow, that is no longer needed                                    
+/// Sub-flows that are missing in this flow are moved here as they are,       
+/// instead of being merged into new empty sub-flows                          
+///   @param other - the flow to merge with this one, left empty              
+void Temporal::Merge(Temporal&& other) {
+   // The priority stack changes, so cached outputs are no longer valid 
+   mIncremental.Reset();
+   ++mGeneration;
+
+   // Concatenate priority stacks                                       
+   mPriorityStack += Abandon(other.mPriorityStack);
+
+   const auto left = other.GetTimesLeft();
+   const auto splice = [&](auto& stack, auto& from, bool periodic) {
+      for (auto pair : from) {
+         auto found = stack.FindIt(pair.mKey);
+         if (found) {
+            found.GetValue().Merge(::std::move(pair.mValue));
+            continue;
+         }
+
+         // Move the whole sub-flow, periodic ones keep their catch-up  
+         // policy and the time left until their execution              
+         if (periodic)
+            Reschedule(pair.mKey, left);
+         stack.Insert(pair.mKey, Abandon(pair.mValue));
+      }
+
+      from.Reset();
    };
 
-   // Merge frequency stacks                                            
-   for (auto pair : other.mFrequencyStack) {
-      auto found = mFrequencyStack.FindIt(pair.mKey);
-      if (not found) {
-         // New time point required                                     
-         mFrequencyStack.Insert(pair.mKey, this);
-         found = mFrequencyStack.FindIt(pair.mKey);
+   splice(mTimeStack, other.mTimeStack, false);
+   splice(mFrequencyStack, other.mFrequencyStack, true);
+   splice(mCompletedStack, other.mCompletedStack, false);
+   other.mSchedule.Reset();
+
+   // Moved sub-flows, and any sub-flows relocated by the               
+   // insertions, still point to their old parents                      
+   Reparent();
+}
+
+/// Capture the state of the flow and all its sub-flows                       
+/// Priority stacks that didn't change since the previous capture aren't      
+/// cloned again                                                              
+///   @return the snapshot                                                    
+auto Temporal::Capture() const -> Snapshot {
+   if (not mCheckpoint or mCheckpoint[0].mGeneration != mGeneration
+   or  mCheckpoint[0].mProgress != mProgress) {
+      // Snapshots might still refer to the previous checkpoint, so     
+      // release it instead of overwriting it                           
+      mCheckpoint.Reset();
+      mCheckpoint << Checkpoint {
+         mGeneration, mProgress,
+         Many {Clone(mPriorityStack)},
+         Many {Clone(mSuspendedOutput)}
+      };
+   }
+
+   Snapshot result;
+   result.mCheckpoint = mCheckpoint;
+   result.mStart = mStart;
+   result.mNow = mNow;
+   result.mSuspended = mSuspended;
+   result.mPeriodic = mPeriodic;
+   result.mCatchUp = mCatchUp;
+   result.mSchedule = TMany<Deadline> {Clone(mSchedule)};
+
+   const auto capture = [](const auto& stack, Snapshot::Stack& into) {
+      for (auto pair : stack)
+         into.Insert(pair.mKey, pair.mValue.Capture());
+   };
+
+   capture(mTimeStack, result.mTimeStack);
+   capture(mFrequencyStack, result.mFrequencyStack);
+   capture(mCompletedStack, result.mCompletedStack);
+   return result;
+}
+
+/// Check if two snapshots share all cloned stacks, i.e. nothing in the flow  
+/// changed between the two captures                                          
+///   @param other - the snapshot to compare with                             
+///   @return true if both snapshots share everything they cloned             
+bool Temporal::Snapshot::Shares(const Snapshot& other) const noexcept {
+   const auto shares = [](const Stack& lhs, const Stack& rhs) {
+      if (lhs.GetCount() != rhs.GetCount())
+         return false;
+
+      for (auto pair : lhs) {
+         const auto found = rhs.FindIt(pair.mKey);
+         if (not found or not pair.mValue.Shares(found.GetValue()))
+            return false;
       }
+      return true;
+   };
+
+   return mCheckpoint.GetRaw() == other.mCheckpoint.GetRaw()
+      and shares(mTimeStack, other.mTimeStack)
+      and shares(mFrequencyStack, other.mFrequencyStack)
+      and shares(mCompletedStack, other.mCompletedStack);
+}
 
-      found.GetValue().Merge(pair.mValue);
+/// Restore the state of the flow and all its sub-flows from a snapshot       
+/// Priority stacks that didn't change since the snapshot are retained        
+///   @param snapshot - the snapshot to restore                               
+void Temporal::Restore(const Snapshot& snapshot) {
+   LANGULUS_ASSUME(DevAssumes, snapshot.IsValid(), "Invalid snapshot");
+
+   const auto& checkpoint = snapshot.mCheckpoint[0];
+   if (mCheckpoint.GetRaw() != &checkpoint or mGeneration != checkpoint.mGeneration
+   or  mProgress != checkpoint.mProgress) {
+      // Clone again, so that the snapshot can be restored many times   
+      mPriorityStack = Many {Clone(checkpoint.mPriorityStack)};
+      mSuspendedOutput = Many {Clone(checkpoint.mSuspendedOutput)};
+      mCheckpoint = snapshot.mCheckpoint;
+      mGeneration = checkpoint.mGeneration;
+      mProgress = checkpoint.mProgress;
+      mIncremental.Reset();
+   }
+
+   mStart = snapshot.mStart;
+   mNow = snapshot.mNow;
+   mSuspended = snapshot.mSuspended;
+   mPeriodic = snapshot.mPeriodic;
+   mCatchUp = snapshot.mCatchUp;
+   mSchedule = TMany<Deadline> {Clone(snapshot.mSchedule)};
+
+   const auto restore = [this](auto& stack, const Snapshot::Stack& from) {
+      // Restore sub-flows in place, so that unchanged ones are skipped 
+      for (auto pair : from)
+         GetOrInsert(stack, pair.mKey, this).Restore(pair.mValue);
+
+      if (stack.GetCount() == from.GetCount())
+         return;
+
+      // Remove sub-flows that were created after the snapshot          
+      TMany<Stamp> removed;
+      for (auto pair : stack) {
+         if (not from.FindIt(pair.mKey))
+            removed << pair.mKey;
+      }
+
+      for (auto key : removed)
+         stack.RemoveKey(key);
    };
+
+   restore(mTimeStack, snapshot.mTimeStack);
+   restore(mFrequencyStack, snapshot.mFrequencyStack);
+   restore(mCompletedStack, snapshot.mCompletedStack);
 }
 
 /// Push a scope of verbs and data to the flow                                
@@ -244,7 +900,14 @@ Many Temporal::PushInner(Many scope) {
 
    // Link new scope with the available stacks                          
    try { Link(compiled); }
-   catch (...) { return {}; }
+   catch (const Except::Flow&) {
+      TEMPORAL_ERRORS("Can't link scope: ", scope);
+
+      // Failed scopes might still partially link, so record them too   
+      if (mSession)
+         mSession->Record(Session::Push, mNow.count(), scope);
+      return {};
+   }
 
    if (mPriorityStack)
       VERBOSE_TEMPORAL(Logger::Purple, "Priority flow: ", mPriorityStack);
@@ -255,7 +918,88 @@ Many Temporal::PushInner(Many scope) {
 
    // Execute the new scope and return any side effects                 
    Many sideffects;
-   Update({}, sideffects);
+   Advance({}, sideffects);
+   if (mSession)
+      mSession->Record(Session::Push, mNow.count(), scope);
+   return Abandon(sideffects);
+}
+
+/// Compile many scopes in a single pass, and link them one by one, so that   
+/// a scope that fails to link doesn't affect the rest                        
+///   @param scopes - a deep container of scopes, in the order of linking;    
+///      any other container is linked as a single scope                      
+///   @return the indices of the scopes that failed to link                   
+TMany<Offset> Temporal::LinkBatch(const Many& scopes) {
+   VERBOSE_TEMPORAL_TAB("Linking ", scopes.GetCount(), " scopes");
+   const auto compiled = Compile(scopes, Inner::NoPriority);
+
+   TMany<Offset> failed;
+   Offset index = 0;
+   const auto link = [&](const Many& scope) {
+      try { Link(scope); }
+      catch (const Except::Flow&) {
+         TEMPORAL_ERRORS("Can't link scope #", index, ": ", scope);
+         failed << index;
+      }
+      ++index;
+   };
+
+   if (compiled.IsDeep() and compiled.IsDense())
+      compiled.ForEach(link);
+   else
+      link(compiled);
+   return failed;
+}
+
+/// Compile and link all scopes that were enqueued since the last Update,     
+/// in the order they were enqueued                                           
+void Temporal::LinkQueued() {
+   const auto scopes = mQueue.Drain();
+   if (not scopes)
+      return;
+
+   LinkBatch(scopes);
+   if (mSession)
+      mSession->Record(Session::Link, mNow.count(), scopes);
+}
+
+/// Push many scopes to the flow at once. All scopes are compiled and         
+/// linked first, and then the flow is updated only once, instead of once     
+/// per scope. Scopes that fail to link are skipped                           
+///   @param scopes - a deep container of scopes, in the order of pushing     
+///   @return the side effects of all scopes                                  
+Many Temporal::PushBatch(const Many& scopes) {
+   TMany<Offset> failed;
+   return PushBatch(scopes, failed);
+}
+
+/// Push many scopes to the flow at once, reporting the ones that failed      
+///   @param scopes - a deep container of scopes, in the order of pushing     
+///   @param failed - [out] the indices of the scopes that failed to link     
+///   @return the side effects of all scopes                                  
+Many Temporal::PushBatch(const Many& scopes, TMany<Offset>& failed) {
+   if (not scopes)
+      return {};
+
+   // Nothing to execute, if none of the scopes were linked             
+   const auto total = scopes.IsDeep() and scopes.IsDense()
+      ? scopes.GetCount() : 1;
+   const auto unlinked = LinkBatch(scopes);
+   failed += unlinked;
+   if (unlinked.GetCount() == total) {
+      if (mSession)
+         mSession->Record(Session::Batch, mNow.count(), scopes);
+      return {};
+   }
+
+   if (mPriorityStack)
+      VERBOSE_TEMPORAL(Logger::Purple, "Priority flow: ", mPriorityStack);
+
+   // Execute all new scopes and return any side effects                
+   Many sideffects;
+   Advance({}, sideffects);
+   if (mSession)
+      mSession->Record(Session::Batch, mNow.count(), scopes);
    return Abandon(sideffects);
 }
 
@@ -452,6 +1196,11 @@ bool Temporal::PushFutures(const Many& scope, Many& stack) {
       }
    );
 
+   // Linking changes the stack, so cached outputs are no longer valid  
+   if (atLeastOneSuccess) {
+      mIncremental.Reset();
+      ++mGeneration;
+   }
    return atLeastOneSuccess;
 }
  
@@ -530,27 +1279,19 @@ void Temporal::Link(const Many& scope) {
                TMany<Verb> local = v;
                local[0].SetTime(0);
 
-               auto found = mTimeStack.FindIt(v.GetTime());
-               if (not found) {
-                  mTimeStack.Insert(v.GetTime(), this);
-                  found = mTimeStack.FindIt(v.GetTime());
-               }
-
-               found.GetValue().LinkRelative(local, v);
+               const auto key = GetTimeStamp(v.GetTime());
+               GetOrInsertTime(key).LinkRelative(local, v);
             }
             else if (v.GetRate()) {
                // Verb is rated, forward it to the frequency stack      
                TMany<Verb> local = v;
                local[0].SetRate(0);
 
-               auto found = mFrequencyStack.FindIt(v.GetRate());
-               if (not found) {
-                  mFrequencyStack.Insert(v.GetRate(), this);
-                  found = mFrequencyStack.FindIt(v.GetRate());
-               }
+               const auto key = GetRateStamp(v.GetRate());
+               auto& flow = GetOrInsertRate(key);
 
                LANGULUS_ASSERT(
-                  found.GetValue().PushFutures(local, found.GetValue().mPriorityStack),
+                  flow.PushFutures(local, flow.mPriorityStack),
                   Flow, "Couldn't push to future"
                );
             }
@@ -590,27 +1331,21 @@ void Temporal::LinkRelative(const Many& scope, const Verb& override) {
             // according to the override verb                           
             if (override.GetTime()) {
                // Trait is timed, forward it to the time stack          
-               auto found = mTimeStack.FindIt(override.GetTime());
-               if (not found) {
-                  mTimeStack.Insert(override.GetTime(), this);
-                  found = mTimeStack.FindIt(override.GetTime());
-               }
+               const auto key = GetTimeStamp(override.GetTime());
+               auto& flow = GetOrInsertTime(key);
 
                LANGULUS_ASSERT(
-                  found.GetValue().PushFutures(local, found.GetValue().mPriorityStack),
+                  flow.PushFutures(local, flow.mPriorityStack),
                   Flow, "Couldn't push to future"
                );
             }
             else if (override.GetRate()) {
                // Verb is rated, forward it to the frequency stack      
-               auto found = mFrequencyStack.FindIt(override.GetRate());
-               if (not found) {
-                  mFrequencyStack.Insert(override.GetRate(), this);
-                  found = mFrequencyStack.FindIt(override.GetRate());
-               }
+               const auto key = GetRateStamp(override.GetRate());
+               auto& flow = GetOrInsertRate(key);
 
                LANGULUS_ASSERT(
-                  found.GetValue().PushFutures(local, found.GetValue().mPriorityStack),
+                  flow.PushFutures(local, flow.mPriorityStack),
                   Flow, "Couldn't push to future"
                );
             }
@@ -629,27 +1364,21 @@ void Temporal::LinkRelative(const Many& scope, const Verb& override) {
             // according to the override verb                           
             if (override.GetTime()) {
                // Trait is timed, forward it to the time stack          
-               auto found = mTimeStack.FindIt(override.GetTime());
-               if (not found) {
-                  mTimeStack.Insert(override.GetTime(), this);
-                  found = mTimeStack.FindIt(override.GetTime());
-               }
+               const auto key = GetTimeStamp(override.GetTime());
+               auto& flow = GetOrInsertTime(key);
 
                LANGULUS_ASSERT(
-                  found.GetValue().PushFutures(local, found.GetValue().mPriorityStack),
+                  flow.PushFutures(local, flow.mPriorityStack),
                   Flow, "Couldn't push to future"
                );
             }
             else if (override.GetRate()) {
                // Verb is rated, forward it to the frequency stack      
-               auto found = mFrequencyStack.FindIt(override.GetRate());
-               if (not found) {
-                  mFrequencyStack.Insert(override.GetRate(), this);
-                  found = mFrequencyStack.FindIt(override.GetRate());
-               }
+               const auto key = GetRateStamp(override.GetRate());
+               auto& flow = GetOrInsertRate(key);
 
                LANGULUS_ASSERT(
-                  found.GetValue().PushFutures(local, found.GetValue().mPriorityStack),
+                  flow.PushFutures(local, flow.mPriorityStack),
                   Flow, "Couldn't push to future"
                );
             }
@@ -673,34 +1402,24 @@ void Temporal::LinkRelative(const Many& scope, const Verb& override) {
             }
             else if (localOverride.GetTime()) {
                // Verb is timed, forward it to the time stack           
-               const auto time = localOverride.GetTime();
+               const auto time = GetTimeStamp(localOverride.GetTime());
                TMany<Verb> local = v;
                local[0].SetTime(0);
 
-               auto found = mTimeStack.FindIt(time);
-               if (not found) {
-                  mTimeStack.Insert(time, this);
-                  found = mTimeStack.FindIt(time);
-               }
-
-               found.GetValue().LinkRelative(local, localOverride);
+               GetOrInsertTime(time).LinkRelative(local, localOverride);
             }
             else if (localOverride.GetRate()) {
                // Verb is rated, forward it to the frequency stack      
-               const auto rate = localOverride.GetRate();
+               const auto rate = GetRateStamp(localOverride.GetRate());
                TMany<Verb> local = v;
                local[0].SetRate(0);
                if (not local[0].GetSource())
                   local[0].SetSource(localOverride.GetSource());
 
-               auto found = mFrequencyStack.FindIt(rate);
-               if (not found) {
-                  mFrequencyStack.Insert(rate, this);
-                  found = mFrequencyStack.FindIt(rate);
-               }
+               auto& flow = GetOrInsertRate(rate);
 
                LANGULUS_ASSERT(
-                  found.GetValue().PushFutures(local, found.GetValue().mPriorityStack),
+                  flow.PushFutures(local, flow.mPriorityStack),
                   Flow, "Couldn't push to future"
                );
             }
@@ -8,6 +8,11 @@
 #pragma once
 #include "Code.hpp"
 #include "Time.hpp"
+#include "Budget.hpp"
+#include "Memo.hpp"
+#include "Session.hpp"
+#include "inner/Incremental.hpp"
+#include "inner/Queue.hpp"
 #include <Anyness/TMap.hpp>
 
 
@@ -21,6 +26,28 @@ namespace Langulus::Flow
    }
 
 
+   ///                                                                        
+   ///   Catch-up policy of a periodic flow                                   
+   ///                                                                        
+   /// Decides what a periodic flow does when more than one of its periods    
+   /// passed since its last execution, for example after a long frame, so    
+   /// that heavy periodic flows can't stall the following frames             
+   ///                                                                        
+   struct CatchUp {
+      enum Mode : uint8_t {
+         All,        // Execute once for each missed period
+         Coalesce,   // Execute once, see Temporal::GetTicks
+         Drop,       // Execute once, and restart the period
+         Cap         // Execute at most mLimit times, drop the rest
+      };
+
+      // What to do with missed periods                                 
+      Mode mMode = All;
+      // Maximum number of executions per Update, when capped           
+      Count mLimit {};
+   };
+
+
    ///                                                                        
    ///   Temporal flow                                                        
    ///                                                                        
@@ -44,6 +71,13 @@ namespace Langulus::Flow
       LANGULUS_CONVERTS_TO(Code, Text);
       friend struct Inner::Missing;
 
+   public:
+      /// Key of the time and frequency stacks - a duration in steady clock   
+      /// units, so that keys are exact, and compared without conversions     
+      using Stamp = Time::rep;
+
+      class Snapshot;
+
    private:
       // Parent flow                                                    
       Temporal* mParent {};
@@ -60,11 +94,66 @@ namespace Langulus::Flow
       // Priority stack, i.e. hierarchy of events that happen once      
       Many mPriorityStack;
       // Verb temporal stack, i.e. events that happen at specific time  
-      // Each unit of time is equal to one mTimePeriod                  
-      TOrderedMap<Real, Temporal> mTimeStack;
+      // Keyed by the uptime at which they happen                       
+      TOrderedMap<Stamp, Temporal> mTimeStack;
       // Verb frequency stack, i.e. events that happen periodically     
-      // Each unit of time is equal to one mRatePeriod                  
-      TUnorderedMap<Real, Temporal> mFrequencyStack;
+      // Keyed by the period at which they happen                       
+      TUnorderedMap<Stamp, Temporal> mFrequencyStack;
+      // Time points that were executed, and have nothing left to run   
+      TOrderedMap<Stamp, Temporal> mCompletedStack;
+
+      // The next execution of a periodic flow, measured in uptime      
+      struct Deadline {
+         Time mTime;
+         Stamp mPeriod;
+      };
+
+      // Min-heap of the next executions of all periodic flows, so that 
+      // updates only touch the periodic flows that are due             
+      TMany<Deadline> mSchedule;
+
+      // Execution budget for a single Update                           
+      Budget mBudget;
+      // Whether the priority stack ran out of budget, or is waiting    
+      // for asynchronous verbs, and has to be resumed on next Update   
+      bool mSuspended {};
+      // Partial outputs of the suspended priority stack                
+      Many mSuspendedOutput;
+      // Memoization table for pure verbs, not owned                    
+      Memo* mMemo {};
+      // Log, where the session is being recorded, not owned            
+      Session* mSession {};
+
+      // Whether this is a periodic flow, executed on each tick         
+      bool mPeriodic {};
+      // What to do with missed periods, if periodic; also inherited    
+      // by any periodic flows created inside                           
+      CatchUp mCatchUp;
+      // Whether sub-flows are updated in parallel                      
+      bool mParallel {};
+      // Scopes enqueued from any thread, linked on the next Update     
+      Inner::ScopeQueue mQueue;
+
+      // Cloned stacks of a single flow, shared between snapshots while 
+      // the flow doesn't change                                        
+      struct Checkpoint {
+         Count mGeneration;
+         Count mProgress;
+         Many mPriorityStack;
+         Many mSuspendedOutput;
+      };
+
+      // Incremented whenever the priority stack changes structurally,  
+      // i.e. when linking or merging                                   
+      Count mGeneration {};
+      // Incremented whenever executing or resetting the priority stack 
+      // leaves progress, that has to be retained between updates       
+      Count mProgress {};
+      // Stacks cloned by the last snapshot, reused while unchanged -   
+      // a single checkpoint, shared by reference with the snapshots    
+      mutable TMany<Checkpoint> mCheckpoint;
+      // Outputs of stable verbs, reused on each tick of periodic flows 
+      Inner::Incremental mIncremental;
 
    protected:
       LANGULUS_API(FLOW) static Many Compile(const Many&, Real priority);
@@ -77,6 +166,24 @@ namespace Langulus::Flow
       LANGULUS_API(FLOW) void LinkRelative(const Many&, const Verb&);
 
       LANGULUS_API(FLOW) Many PushInner(Many);
+      LANGULUS_API(FLOW) TMany<Offset> LinkBatch(const Many&);
+      LANGULUS_API(FLOW) void LinkQueued();
+
+      NOD() LANGULUS_API(FLOW) Stamp GetTimeStamp(Real) const noexcept;
+      NOD() LANGULUS_API(FLOW) Stamp GetRateStamp(Real) const noexcept;
+
+      LANGULUS_API(FLOW) Temporal& GetOrInsertTime(Stamp);
+      LANGULUS_API(FLOW) Temporal& GetOrInsertRate(Stamp);
+
+      LANGULUS_API(FLOW) void Schedule(Stamp, Temporal&);
+      LANGULUS_API(FLOW) void Schedule(Stamp, Time);
+      NOD() LANGULUS_API(FLOW) TUnorderedMap<Stamp, Time> GetTimesLeft() const;
+      LANGULUS_API(FLOW) void Reschedule(Stamp, const TUnorderedMap<Stamp, Time>&);
+      LANGULUS_API(FLOW) void Reparent();
+      NOD() LANGULUS_API(FLOW) bool IsRetired() const noexcept;
+      NOD() LANGULUS_API(FLOW) bool IsThreadSafe() const;
+      LANGULUS_API(FLOW) void UpdatePeriodic(Deadline&, Time, Many&);
+      LANGULUS_API(FLOW) bool Advance(Time, Many&);
 
    public:
       LANGULUS_API(FLOW) Temporal();
@@ -99,21 +206,113 @@ namespace Langulus::Flow
       NOD() LANGULUS_API(FLOW)
       Time GetUptime() const;
 
+      LANGULUS_API(FLOW) void SetBudget(const Budget&) noexcept;
+      NOD() LANGULUS_API(FLOW)
+      const Budget& GetBudget() const noexcept;
+      NOD() LANGULUS_API(FLOW)
+      bool IsSuspended() const noexcept;
+
+      LANGULUS_API(FLOW) void SetParallel(bool) noexcept;
+      NOD() LANGULUS_API(FLOW)
+      bool IsParallel() const noexcept;
+
+      LANGULUS_API(FLOW) void SetMemo(Memo*) noexcept;
+      NOD() LANGULUS_API(FLOW)
+      Memo* GetMemo() const noexcept;
+
+      LANGULUS_API(FLOW) void SetSession(Session*) noexcept;
+      NOD() LANGULUS_API(FLOW)
+      Session* GetSession() const noexcept;
+      LANGULUS_API(FLOW) Many Replay(const Session&);
+
+      LANGULUS_API(FLOW) void SetCatchUp(const CatchUp&);
+      LANGULUS_API(FLOW) void SetCatchUp(Real, const CatchUp&);
+      NOD() LANGULUS_API(FLOW)
+      CatchUp GetCatchUp(Real) const;
+      NOD() LANGULUS_API(FLOW)
+      static Count GetTicks() noexcept;
+
       LANGULUS_API(FLOW) void Merge(const Temporal&);
+      LANGULUS_API(FLOW) void Merge(Temporal&&);
+
+      NOD() LANGULUS_API(FLOW)
+      Snapshot Capture() const;
+      LANGULUS_API(FLOW) void Restore(const Snapshot&);
 
+      /// Push scopes to the flow, and execute them                           
+      /// Many scopes are linked together, and executed only once             
+      ///   @param tn - the scopes to push                                    
+      ///   @return the side effects of all scopes                            
       template<CT::Data...TN> requires (sizeof...(TN) >= 1)
       Many Push(TN&&...tn) {
-         Many result;
-         (result.SmartPush(IndexBack, PushInner(Forward<TN>(tn))), ...);
-         return result;
+         if constexpr (sizeof...(TN) == 1)
+            return PushInner(Forward<TN>(tn)...);
+         else {
+            Many scopes;
+            (scopes << Many {Forward<TN>(tn)}, ...);
+            return PushBatch(scopes);
+         }
+      }
+
+      LANGULUS_API(FLOW) Many PushBatch(const Many&);
+      LANGULUS_API(FLOW) Many PushBatch(const Many&, TMany<Offset>&);
+
+      /// Enqueue scopes from any thread, to be compiled and linked           
+      /// together at the start of the next Update, in the order they         
+      /// were enqueued                                                       
+      ///   @attention scopes must not be shared with other threads, so       
+      ///      prefer moving them in                                          
+      ///   @param tn - the scopes to enqueue                                 
+      template<CT::Data...TN> requires (sizeof...(TN) >= 1)
+      void Enqueue(TN&&...tn) {
+         (mQueue.Push(Many {Forward<TN>(tn)}), ...);
       }
 
       LANGULUS_API(FLOW) void Reset();
       LANGULUS_API(FLOW) bool Update(Time, Many&);
       LANGULUS_API(FLOW) void Dump() const;
+   };
 
-   protected:
-      void ResetInner(Many&);
+
+   ///                                                                        
+   ///   Snapshot of a temporal flow                                          
+   ///                                                                        
+   ///   Made by Temporal::Capture, and applied by Temporal::Restore. The     
+   /// priority stack of each flow is cloned only if it changed since the     
+   /// previous capture, otherwise the clone is shared with it, so capturing  
+   /// a session every frame costs in proportion to what changed. Restoring   
+   /// skips the flows that didn't change since the snapshot in the same way. 
+   ///   Flow settings, such as budget, memoization, periods and enqueued     
+   /// scopes, are not part of the snapshot.                                  
+   ///                                                                        
+   class Temporal::Snapshot {
+      friend class Temporal;
+      using Stack = TOrderedMap<Stamp, Snapshot>;
+
+      // The cloned priority stack and suspended outputs                
+      TMany<Checkpoint> mCheckpoint;
+      // Progress of the flow                                           
+      Time mStart;
+      Time mNow;
+      bool mSuspended {};
+      bool mPeriodic {};
+      CatchUp mCatchUp;
+      TMany<Deadline> mSchedule;
+      // Snapshots of the sub-flows                                     
+      Stack mTimeStack;
+      Stack mFrequencyStack;
+      Stack mCompletedStack;
+
+   public:
+      /// Check if the snapshot was captured from a flow                      
+      ///   @return true if snapshot can be restored                          
+      NOD() LANGULUS(INLINED)
+      bool IsValid() const noexcept {
+         return static_cast<bool>(mCheckpoint);
+      }
+
+      NOD() LANGULUS_API(FLOW)
+      bool Shares(const Snapshot&) const noexcept;
    };
 
 } // namespace Langulus::Flow
@@ -152,6 +152,9 @@ namespace Langulus::Flow
 
       template<CT::Dense>
       bool GenericAvailableFor() const noexcept;
+      NOD() static bool IsAvailableFor(DMeta, VMeta);
+      template<CT::Dense, CT::Verb>
+      NOD() static bool IsAvailableFor();
       static bool GenericExecuteIn(CT::Dense auto&, CT::VerbBased auto&);
       static bool GenericExecuteDefault(Many const&, CT::VerbBased auto&);
       static bool GenericExecuteDefault(Many&, CT::VerbBased auto&);
@@ -9,6 +9,7 @@
 #include "Verb.hpp"
 #include "Code.inl"
 #include "verbs/Interpret.hpp"
+#include "inner/Dispatch.hpp"
 
 
 namespace Langulus::Flow
@@ -525,15 +526,43 @@ namespace Langulus::Flow
       return mSuccesses;
    }
 
-   /// Check if reflected abilities in T support this verb                    
-   /// This is a slow runtime check, use statically optimized variants inside 
-   /// specific verbs if you know them at compile time                        
-   ///   @return true if the ability exists                                   
+   /// Check if T can execute this verb with its current argument, either     
+   /// via a registered trampoline, or a reflected ability. This is a runtime 
+   /// check, use statically optimized variants inside specific verbs if you  
+   /// know them at compile time. It's a single dispatcher lookup, the same   
+   /// one that is used when the verb is executed                             
+   ///   @return true if the verb can be executed in T                        
    template<CT::Dense T> LANGULUS(INLINED)
    bool Verb::GenericAvailableFor() const noexcept {
-      const auto meta = MetaDataOf<Decay<T>>();
-      return meta and meta->template
-         GetAbility<CT::Mutable<Deref<T>>>(mVerb, GetType());
+      const auto dispatcher = Inner::FindDispatcher(
+         MetaDataOf<Decay<T>>(), mVerb, GetType());
+      if constexpr (CT::Mutable<Deref<T>>) {
+         return dispatcher.mTrampolineMutable or dispatcher.mTrampolineConstant
+             or dispatcher.mAbilityMutable;
+      }
+      else return dispatcher.mTrampolineConstant or dispatcher.mAbilityConstant;
+   }
+
+   /// Check if a type can execute a verb in any way, without building a      
+   /// verb first. The result is computed once per type and verb, so after    
+   /// the first query this is a single load, or a per-thread cache probe     
+   /// for types without registered trampolines                               
+   ///   @param type - the type to check                                      
+   ///   @param verb - the verb to check                                      
+   ///   @return true if type has any kind of ability for the verb            
+   LANGULUS(INLINED)
+   bool Verb::IsAvailableFor(DMeta type, VMeta verb) {
+      return Inner::IsAvailable(type, verb);
+   }
+
+   /// Check if a type can execute a verb in any way, without building a      
+   /// verb first                                                             
+   ///   @tparam T - the type to check                                        
+   ///   @tparam V - the verb to check                                        
+   ///   @return true if type has any kind of ability for the verb            
+   template<CT::Dense T, CT::Verb V> LANGULUS(INLINED)
+   bool Verb::IsAvailableFor() {
+      return Inner::IsAvailable(MetaDataOf<Decay<T>>(), MetaVerbOf<V>());
    }
 
    /// Execute a known/unknown verb in an known/unknown context               
@@ -571,7 +600,7 @@ namespace Langulus::Flow
                toMeta = verb.template As<DMeta>();
             }
 
-            const auto foundConverter = meta->GetConverter(toMeta);
+            const auto foundConverter = Inner::FindConverter(meta, toMeta);
             if (foundConverter) {
                // Converter was found, prioritize it                    
                // No escape from this scope                             
@@ -583,13 +612,29 @@ namespace Langulus::Flow
             }
          }
 
-         // Scan for any other runtime ability                          
-         const auto foundAbility = meta->template
-            GetAbility<CT::Mutable<T>>(verb.GetVerb(), verb.GetType());
-         if (not foundAbility)
-            return false;
-
-         foundAbility(context.GetRaw(), verb);
+         // Statically generated trampolines, or reflected abilities    
+         // for types that don't have any                               
+         const auto dispatcher = Inner::FindDispatcher(
+            meta, verb.GetVerb(), verb.GetType());
+
+         if constexpr (CT::Mutable<T>) {
+            if (dispatcher.mTrampolineMutable)
+               dispatcher.mTrampolineMutable(context.GetRaw(), verb);
+            else if (dispatcher.mTrampolineConstant)
+               dispatcher.mTrampolineConstant(context.GetRaw(), verb);
+            else if (dispatcher.mAbilityMutable)
+               dispatcher.mAbilityMutable(context.GetRaw(), verb);
+            else
+               return false;
+         }
+         else {
+            if (dispatcher.mTrampolineConstant)
+               dispatcher.mTrampolineConstant(context.GetRaw(), verb);
+            else if (dispatcher.mAbilityConstant)
+               dispatcher.mAbilityConstant(context.GetRaw(), verb);
+            else
+               return false;
+         }
       }
 
       return verb.IsDone();
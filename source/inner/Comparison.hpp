@@ -0,0 +1,283 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../Verb.hpp"
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+
+namespace Langulus::Flow::Inner
+{
+
+   /// Comparisons, performed by the default comparison verbs                 
+   enum class Comparison {
+      Equal,
+      Lower,
+      LowerOrEqual,
+      Greater,
+      GreaterOrEqual,
+      ThreeWay
+   };
+
+   /// Type of a single comparison result - three-way comparisons produce     
+   /// -1, 0 or 1, while all others produce a mask of booleans                
+   template<Comparison OP>
+   using ComparisonResult = ::std::conditional_t<
+      OP == Comparison::ThreeWay, ::std::int8_t, bool>;
+
+   /// Compare two built-in numbers. Integers of different types are          
+   /// compared exactly, regardless of their signedness and size              
+   ///   @param lhs - left operand                                            
+   ///   @param rhs - right operand                                           
+   ///   @return the result of the comparison                                 
+   template<Comparison OP, class L, class R> LANGULUS(INLINED)
+   constexpr ComparisonResult<OP> CompareElement(const L lhs, const R rhs) noexcept {
+      if constexpr (not ::std::is_same_v<L, R>) {
+         static_assert(::std::is_integral_v<L> and ::std::is_integral_v<R>,
+            "Only integers of different types can be compared exactly");
+         if constexpr (OP == Comparison::Equal)
+            return ::std::cmp_equal(lhs, rhs);
+         else if constexpr (OP == Comparison::Lower)
+            return ::std::cmp_less(lhs, rhs);
+         else if constexpr (OP == Comparison::LowerOrEqual)
+            return ::std::cmp_less_equal(lhs, rhs);
+         else if constexpr (OP == Comparison::Greater)
+            return ::std::cmp_greater(lhs, rhs);
+         else if constexpr (OP == Comparison::GreaterOrEqual)
+            return ::std::cmp_greater_equal(lhs, rhs);
+         else {
+            return static_cast<::std::int8_t>(
+               ::std::cmp_greater(lhs, rhs) - ::std::cmp_less(lhs, rhs));
+         }
+      }
+      else if constexpr (OP == Comparison::Equal)
+         return lhs == rhs;
+      else if constexpr (OP == Comparison::Lower)
+         return lhs < rhs;
+      else if constexpr (OP == Comparison::LowerOrEqual)
+         return lhs <= rhs;
+      else if constexpr (OP == Comparison::Greater)
+         return lhs > rhs;
+      else if constexpr (OP == Comparison::GreaterOrEqual)
+         return lhs >= rhs;
+      else
+         return static_cast<::std::int8_t>((lhs > rhs) - (lhs < rhs));
+   }
+
+   /// Compare contiguous arrays of built-in numbers element by element       
+   /// Loops are branchless and operate on contiguous memory, so that         
+   /// compilers vectorize them. If one of the sides has a single element,    
+   /// it is compared against all elements of the other side                  
+   ///   @param lhs - left operands                                           
+   ///   @param lhsCount - number of left operands                            
+   ///   @param rhs - right operands                                          
+   ///   @param rhsCount - number of right operands                           
+   ///   @param output - where results are written, must have room for the    
+   ///      larger of the counts                                              
+   template<Comparison OP, class L, class R>
+   void CompareKernel(
+      const L* lhs, const Count lhsCount,
+      const R* rhs, const Count rhsCount,
+      ComparisonResult<OP>* output
+   ) noexcept {
+      if (rhsCount == 1) {
+         const R r = *rhs;
+         for (Count i = 0; i < lhsCount; ++i)
+            output[i] = CompareElement<OP>(lhs[i], r);
+      }
+      else if (lhsCount == 1) {
+         const L l = *lhs;
+         for (Count i = 0; i < rhsCount; ++i)
+            output[i] = CompareElement<OP>(l, rhs[i]);
+      }
+      else {
+         for (Count i = 0; i < lhsCount; ++i)
+            output[i] = CompareElement<OP>(lhs[i], rhs[i]);
+      }
+   }
+
+   /// A list of types                                                        
+   template<class...>
+   struct TypeList {};
+
+   /// Built-in numbers that have comparison kernels                          
+   using ComparableNumbers = TypeList<
+      ::std::int8_t,  ::std::uint8_t,
+      ::std::int16_t, ::std::uint16_t,
+      ::std::int32_t, ::std::uint32_t,
+      ::std::int64_t, ::std::uint64_t,
+      float, double
+   >;
+
+   /// Built-in integers, that are compared exactly even if their types       
+   /// differ, because converting 64-bit integers to double loses precision   
+   using ComparableIntegers = TypeList<
+      ::std::int8_t,  ::std::uint8_t,
+      ::std::int16_t, ::std::uint16_t,
+      ::std::int32_t, ::std::uint32_t,
+      ::std::int64_t, ::std::uint64_t
+   >;
+
+   /// Get the raw elements of a block, that is known to contain T            
+   template<class T> LANGULUS(INLINED)
+   const T* RawAs(const Many& block) noexcept {
+      return static_cast<const T*>(static_cast<const void*>(block.GetRaw()));
+   }
+
+   /// Check if counts of two blocks allow element-wise comparison            
+   LANGULUS(INLINED)
+   bool AreComparable(const Many& lhs, const Many& rhs) noexcept {
+      return lhs.IsDense() and rhs.IsDense() and lhs and rhs
+         and (lhs.GetCount() == rhs.GetCount()
+           or lhs.GetCount() == 1 or rhs.GetCount() == 1);
+   }
+
+   /// Compare two dense blocks of built-in number types L and R              
+   ///   @param lhs - left operands                                           
+   ///   @param rhs - right operands                                          
+   ///   @param output - [out] the results are pushed here                    
+   ///   @return true if blocks were of types L and R, and were compared      
+   template<Comparison OP, class L, class R = L>
+   bool CompareTyped(const Many& lhs, const Many& rhs, Many& output) {
+      if (not lhs.IsExact<L>() or not rhs.IsExact<R>())
+         return false;
+
+      TMany<ComparisonResult<OP>> result;
+      result.New(::std::max(lhs.GetCount(), rhs.GetCount()));
+      CompareKernel<OP>(
+         RawAs<L>(lhs), lhs.GetCount(),
+         RawAs<R>(rhs), rhs.GetCount(),
+         result.GetRaw()
+      );
+
+      output << Abandon(result);
+      return true;
+   }
+
+   /// Compare two dense blocks of built-in integers of different types       
+   ///   @param lhs - left operands                                           
+   ///   @param rhs - right operands                                          
+   ///   @param output - [out] the results are pushed here                    
+   ///   @return true if both blocks were integers, and were compared         
+   template<Comparison OP, class L>
+   bool CompareIntegers(const Many& lhs, const Many& rhs, Many& output) {
+      if (not lhs.IsExact<L>())
+         return false;
+
+      return [&]<class...R>(TypeList<R...>) {
+         return (CompareTyped<OP, L, R>(lhs, rhs, output) or ...);
+      }(ComparableIntegers {});
+   }
+
+   /// Convert a dense block of any built-in number type to doubles, so       
+   /// that blocks of different number types can be compared                  
+   ///   @param from - the block to convert                                   
+   ///   @param to - [out] the converted numbers                              
+   ///   @return true if block was of type T, and was converted               
+   template<class T>
+   bool ConvertToReal(const Many& from, TMany<double>& to) {
+      if (not from.IsExact<T>())
+         return false;
+
+      to.New(from.GetCount());
+      const auto source = RawAs<T>(from);
+      const auto target = to.GetRaw();
+      for (Count i = 0; i < from.GetCount(); ++i)
+         target[i] = static_cast<double>(source[i]);
+      return true;
+   }
+
+   /// Compare two blocks element-wise, and push the results in output        
+   /// Blocks of the same built-in number type are compared directly,         
+   /// integers of different types are compared exactly, any other blocks of  
+   /// different built-in number types are compared as doubles, and all       
+   /// other blocks are compared as a whole, via their reflected comparison   
+   /// operators - those can only be checked for equality. Blocks that can't  
+   /// be compared element-wise, because of their counts, are never equal     
+   ///   @param lhs - left operands                                           
+   ///   @param rhs - right operands                                          
+   ///   @param output - [out] the results are pushed here                    
+   ///   @return true if blocks were compared                                 
+   template<Comparison OP>
+   bool CompareBlocks(const Many& lhs, const Many& rhs, Many& output) {
+      if (not AreComparable(lhs, rhs)) {
+         if constexpr (OP == Comparison::Equal) {
+            output << (lhs == rhs);
+            return true;
+         }
+         else return false;
+      }
+
+      // Blocks of the same built-in number type                        
+      const bool same = [&]<class...T>(TypeList<T...>) {
+         return (CompareTyped<OP, T>(lhs, rhs, output) or ...);
+      }(ComparableNumbers {});
+      if (same)
+         return true;
+
+      // Blocks of different built-in integer types                     
+      const bool integers = [&]<class...T>(TypeList<T...>) {
+         return (CompareIntegers<OP, T>(lhs, rhs, output) or ...);
+      }(ComparableIntegers {});
+      if (integers)
+         return true;
+
+      // Blocks of different built-in number types                      
+      TMany<double> lhsReal, rhsReal;
+      const bool numbers = [&]<class...T>(TypeList<T...>) {
+         return (ConvertToReal<T>(lhs, lhsReal) or ...)
+            and (ConvertToReal<T>(rhs, rhsReal) or ...);
+      }(ComparableNumbers {});
+      if (numbers)
+         return CompareTyped<OP, double>(lhsReal, rhsReal, output);
+
+      // Any other blocks, compared via reflected operators             
+      if constexpr (OP == Comparison::Equal) {
+         output << (lhs == rhs);
+         return true;
+      }
+      else if constexpr (OP == Comparison::ThreeWay) {
+         // Unordered types can only be compared for equality           
+         if (lhs != rhs)
+            return false;
+         output << ::std::int8_t {0};
+         return true;
+      }
+      else return false;
+   }
+
+   /// Default implementation of the comparison verbs - compares context      
+   /// against each flat part of the verb's argument, and pushes a mask       
+   /// (or three-way results) for each of them in the verb's output           
+   ///   @param context - the left operands                                   
+   ///   @param verb - the comparison verb                                    
+   ///   @return true if at least one comparison was made                     
+   template<Comparison OP>
+   bool CompareDefault(const Many& context, Verb& verb) {
+      if (verb.IsMissing() or not context or context.IsMissing())
+         return false;
+
+      Many output;
+      const auto& argument = verb.GetArgument();
+      if (argument.IsDeep()) {
+         // Consider the hierarchy                                      
+         argument.ForEach([&](const Many& part) {
+            CompareBlocks<OP>(context, part, output);
+         });
+      }
+      else CompareBlocks<OP>(context, argument, output);
+
+      if (not output)
+         return false;
+
+      verb << Abandon(output);
+      return verb.IsDone();
+   }
+
+} // namespace Langulus::Flow::Inner
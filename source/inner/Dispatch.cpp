@@ -0,0 +1,593 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Dispatch.hpp"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+
+namespace Langulus::Flow::Inner
+{
+   namespace
+   {
+
+      /// Number of entries in each per-thread cache, must be power of two    
+      constexpr Offset CacheSize = 256;
+
+      /// Incremented each time reflected abilities might have changed,       
+      /// for example when a module is loaded or unloaded. Entries that       
+      /// were cached in an older generation are considered empty             
+      ::std::atomic<uint32_t> Generation {1};
+
+      /// Number of abilities reflected directly in a type. Cached searches   
+      /// remember it, so that abilities reflected after a search are         
+      /// noticed without an explicit InvalidateDispatchCache                 
+      Count ReflectedAbilities(DMeta type) noexcept {
+         return static_cast<Count>(type->mAbilities.size());
+      }
+
+      /// Number of converters reflected directly in a type, see above        
+      Count ReflectedConverters(DMeta type) noexcept {
+         return static_cast<Count>(type->mConverters.size());
+      }
+
+      /// A cached ability search                                             
+      template<class F>
+      struct AbilityEntry {
+         DMeta mType;
+         VMeta mVerb;
+         DMeta mArgument;
+         uint32_t mGeneration {};
+         Count mReflected {};
+         F mFunction {};
+      };
+
+      /// A cached converter search                                           
+      struct ConverterEntry {
+         DMeta mFrom;
+         DMeta mTo;
+         uint32_t mGeneration {};
+         Count mReflected {};
+         Converter mFunction {};
+      };
+
+      /// Direct-mapped caches - each thread has its own, so no locking       
+      /// is required, and misses (including negative ones) simply            
+      /// overwrite whatever was in the slot                                  
+      thread_local AbilityEntry<AbilityMutable>  MutableCache[CacheSize];
+      thread_local AbilityEntry<AbilityConstant> ConstantCache[CacheSize];
+      thread_local ConverterEntry ConverterCache[CacheSize];
+
+      /// Search a cache for an ability, searching RTTI on miss               
+      template<bool MUTABLE, class F>
+      F Find(AbilityEntry<F>* cache, DMeta type, VMeta verb, DMeta argument) noexcept {
+         const auto generation = Generation.load(::std::memory_order_relaxed);
+         const auto reflected = ReflectedAbilities(type);
+         auto& entry = cache[HashOf(type, verb, argument).mHash & (CacheSize - 1)];
+         if (entry.mGeneration == generation and entry.mReflected == reflected
+         and entry.mType == type and entry.mVerb == verb and entry.mArgument == argument)
+            return entry.mFunction;
+
+         entry.mType = type;
+         entry.mVerb = verb;
+         entry.mArgument = argument;
+         entry.mGeneration = generation;
+         entry.mReflected = reflected;
+         entry.mFunction = type->template GetAbility<MUTABLE>(verb, argument);
+         return entry.mFunction;
+      }
+
+      /// A registered whole-block ability                                    
+      struct BatchRecord {
+         DMeta mType;
+         VMeta mVerb;
+         BatchAbilityMutable mMutable {};
+         BatchAbilityConstant mConstant {};
+      };
+
+      /// Registered whole-block abilities - there are only a few of them,    
+      /// and they're searched only on cache misses, so a linear search is    
+      /// good enough                                                         
+      ::std::shared_mutex BatchGuard;
+      TMany<BatchRecord> BatchRegistry;
+
+      thread_local AbilityEntry<BatchAbilityMutable>  BatchMutableCache[CacheSize];
+      thread_local AbilityEntry<BatchAbilityConstant> BatchConstantCache[CacheSize];
+
+      /// Search the registry for a whole-block ability                       
+      template<bool MUTABLE>
+      BatchAbility<MUTABLE> FindBatchRecord(DMeta type, VMeta verb) {
+         const ::std::shared_lock lock {BatchGuard};
+         for (auto& record : BatchRegistry) {
+            if (record.mType != type or record.mVerb != verb)
+               continue;
+
+            if constexpr (MUTABLE)
+               return record.mMutable;
+            else
+               return record.mConstant;
+         }
+         return nullptr;
+      }
+
+      /// Search a cache for a whole-block ability, searching the registry    
+      /// on miss                                                             
+      template<bool MUTABLE, class F>
+      F FindBatch(AbilityEntry<F>* cache, DMeta type, VMeta verb) noexcept {
+         const auto generation = Generation.load(::std::memory_order_relaxed);
+         auto& entry = cache[HashOf(type, verb).mHash & (CacheSize - 1)];
+         if (entry.mGeneration == generation
+         and entry.mType == type and entry.mVerb == verb)
+            return entry.mFunction;
+
+         entry.mType = type;
+         entry.mVerb = verb;
+         entry.mArgument = {};
+         entry.mGeneration = generation;
+         entry.mFunction = FindBatchRecord<MUTABLE>(type, verb);
+         return entry.mFunction;
+      }
+
+      /// Get the record for a type and verb, creating it if missing          
+      /// BatchGuard must be exclusively locked                               
+      BatchRecord& GetBatchRecord(DMeta type, VMeta verb) {
+         for (auto& record : BatchRegistry) {
+            if (record.mType == type and record.mVerb == verb)
+               return record;
+         }
+
+         BatchRegistry << BatchRecord {type, verb};
+         return BatchRegistry[BatchRegistry.GetCount() - 1];
+      }
+
+      /// Limits of the static dispatch tables - types and verbs beyond       
+      /// these simply don't get an id, and are dispatched via RTTI           
+      constexpr Count MaxTypeIds = 4096;
+      constexpr Count MaxVerbIds = 256;
+
+      /// An id slot in an open-addressed table, written only once, under     
+      /// TableGuard. Readers never lock - a slot is valid once mReady is set 
+      template<class META>
+      struct IdSlot {
+         ::std::atomic<bool> mReady {};
+         META mMeta {};
+         Count mId {};
+      };
+
+      /// Availability of a verb in a type is stored along with the dispatch  
+      /// cache generation it was computed in, so that it's invalidated       
+      /// without clearing anything, and a result computed right before an    
+      /// invalidation can never be mistaken for a fresh one                  
+      constexpr uint32_t AvailableBit = 1;
+      constexpr uint32_t GenerationShift = 1;
+
+      /// Tag an availability with the generation it was computed in          
+      constexpr uint32_t TagAvailability(uint32_t generation, bool available) noexcept {
+         return (generation << GenerationShift) | (available ? AvailableBit : 0);
+      }
+
+      /// A row of trampolines for a single type, indexed by verb id, and     
+      /// lazily computed, generation-tagged availability for each verb id    
+      struct Row {
+         ::std::atomic<TrampolineMutable>  mMutable[MaxVerbIds] {};
+         ::std::atomic<TrampolineConstant> mConstant[MaxVerbIds] {};
+         ::std::atomic<uint32_t> mAvailability[MaxVerbIds] {};
+         // Reflected abilities the availabilities were computed with   
+         ::std::atomic<Count> mReflected {};
+      };
+
+      ::std::mutex TableGuard;
+      IdSlot<DMeta> TypeIds[MaxTypeIds * 2];
+      IdSlot<VMeta> VerbIds[MaxVerbIds * 2];
+      Count TypeIdCounter = 0;
+      Count VerbIdCounter = 0;
+
+      /// A cached availability, for pairs without a row in the tables        
+      struct AvailabilityEntry {
+         DMeta mType;
+         VMeta mVerb;
+         uint32_t mGeneration {};
+         Count mReflected {};
+         bool mAvailable {};
+      };
+
+      thread_local AvailabilityEntry AvailabilityCache[CacheSize];
+
+      /// The first level of the table, indexed by type id. Rows are never    
+      /// released, so readers can use them without locking. Each row is      
+      /// allocated in its own container, so that it never moves              
+      ::std::atomic<Row*> Rows[MaxTypeIds] {};
+      TMany<TMany<Row>> RowStorage;
+
+      /// Search for the id of a meta                                         
+      ///   @return the id, or zero if meta has no id                         
+      template<class META, Count SIZE>
+      Count FindId(IdSlot<META> (&slots)[SIZE], META meta) noexcept {
+         if (not meta)
+            return 0;
+
+         auto index = HashOf(meta).mHash;
+         for (Count probe = 0; probe < SIZE; ++probe, ++index) {
+            const auto& slot = slots[index % SIZE];
+            if (not slot.mReady.load(::std::memory_order_acquire))
+               return 0;
+            if (slot.mMeta == meta)
+               return slot.mId;
+         }
+         return 0;
+      }
+
+      /// Get the id of a meta, assigning a new one if needed                 
+      /// TableGuard must be locked                                           
+      ///   @return the id, or zero if table is full                          
+      template<class META, Count SIZE>
+      Count AssignId(
+         IdSlot<META> (&slots)[SIZE], Count& counter, Count limit, META meta
+      ) {
+         auto index = HashOf(meta).mHash;
+         for (Count probe = 0; probe < SIZE; ++probe, ++index) {
+            auto& slot = slots[index % SIZE];
+            if (slot.mReady.load(::std::memory_order_relaxed)) {
+               if (slot.mMeta == meta)
+                  return slot.mId;
+               continue;
+            }
+
+            if (counter + 1 >= limit)
+               return 0;
+
+            slot.mMeta = meta;
+            slot.mId = ++counter;
+            slot.mReady.store(true, ::std::memory_order_release);
+            return slot.mId;
+         }
+         return 0;
+      }
+
+      /// Get the row of a type, creating it if missing                       
+      /// TableGuard must be locked                                           
+      Row* GetRow(Count typeId) {
+         auto row = Rows[typeId].load(::std::memory_order_relaxed);
+         if (not row) {
+            TMany<Row> storage;
+            storage.New(1);
+            row = storage.GetRaw();
+            RowStorage << Abandon(storage);
+            Rows[typeId].store(row, ::std::memory_order_release);
+         }
+         return row;
+      }
+
+      /// Check if a type has a reflected ability, a trampoline, or a         
+      /// whole-block ability for a verb - this is the slow check, whose      
+      /// results are kept in the availability bitsets                        
+      bool ComputeAvailability(DMeta type, VMeta verb) {
+         if (type->mAbilities.find(verb) != type->mAbilities.end())
+            return true;
+         for (auto& base : type->mBases) {
+            // Abilities might be inherited                             
+            if (base.mType and ComputeAvailability(base.mType, verb))
+               return true;
+         }
+         if (FindTrampolineMutable(type, verb) or FindTrampolineConstant(type, verb))
+            return true;
+         return FindBatchRecord<true>(type, verb) or FindBatchRecord<false>(type, verb);
+      }
+
+      /// A cached dispatcher resolution                                      
+      struct DispatcherEntry {
+         DMeta mType;
+         VMeta mVerb;
+         DMeta mArgument;
+         uint32_t mGeneration {};
+         Count mReflected {};
+         Dispatcher mDispatcher;
+      };
+
+      thread_local DispatcherEntry DispatcherCache[CacheSize];
+
+      /// Verbs that can be dispatched to different subblocks of the same     
+      /// context from multiple threads at once, indexed by verb id           
+      ::std::atomic<bool> ThreadSafeVerbs[MaxVerbIds] {};
+
+   } // namespace Langulus::Flow::Inner::<anonymous>
+
+
+   /// Find a reflected ability for a mutable context, using the cache        
+   ///   @param type - the type of the context                                
+   ///   @param verb - the verb to search for                                 
+   ///   @param argument - the type of the verb argument                      
+   ///   @return the ability, or nullptr if not reflected                     
+   AbilityMutable FindAbilityMutable(DMeta type, VMeta verb, DMeta argument) noexcept {
+      return Find<true>(MutableCache, type, verb, argument);
+   }
+
+   /// Find a reflected ability for a constant context, using the cache       
+   ///   @param type - the type of the context                                
+   ///   @param verb - the verb to search for                                 
+   ///   @param argument - the type of the verb argument                      
+   ///   @return the ability, or nullptr if not reflected                     
+   AbilityConstant FindAbilityConstant(DMeta type, VMeta verb, DMeta argument) noexcept {
+      return Find<false>(ConstantCache, type, verb, argument);
+   }
+
+   /// Find a reflected converter, using the cache                            
+   ///   @param from - the type to convert from                               
+   ///   @param to - the type to convert to                                   
+   ///   @return the converter, or nullptr if not reflected                   
+   Converter FindConverter(DMeta from, DMeta to) noexcept {
+      const auto generation = Generation.load(::std::memory_order_relaxed);
+      const auto reflected = ReflectedConverters(from);
+      auto& entry = ConverterCache[HashOf(from, to).mHash & (CacheSize - 1)];
+      if (entry.mGeneration == generation and entry.mReflected == reflected
+      and entry.mFrom == from and entry.mTo == to)
+         return entry.mFunction;
+
+      entry.mFrom = from;
+      entry.mTo = to;
+      entry.mGeneration = generation;
+      entry.mReflected = reflected;
+      entry.mFunction = from->GetConverter(to);
+      return entry.mFunction;
+   }
+
+   /// Invalidate the dispatch caches in all threads. Abilities and           
+   /// converters reflected in an already searched type are noticed without   
+   /// this - call it only when reflected abilities are replaced, or when     
+   /// types are unregistered at runtime                                      
+   void InvalidateDispatchCache() noexcept {
+      Generation.fetch_add(1, ::std::memory_order_release);
+   }
+
+   /// Register a whole-block ability for a mutable block                     
+   ///   @param type - the type of the block elements                         
+   ///   @param verb - the verb the ability implements                        
+   ///   @param ability - the ability, or nullptr to remove it                
+   void RegisterBatchAbility(DMeta type, VMeta verb, BatchAbilityMutable ability) {
+      LANGULUS_ASSUME(DevAssumes, type and verb, "Invalid batch ability");
+      {
+         const ::std::unique_lock lock {BatchGuard};
+         GetBatchRecord(type, verb).mMutable = ability;
+      }
+      InvalidateDispatchCache();
+   }
+
+   /// Register a whole-block ability for a constant block                    
+   ///   @param type - the type of the block elements                         
+   ///   @param verb - the verb the ability implements                        
+   ///   @param ability - the ability, or nullptr to remove it                
+   void RegisterBatchAbility(DMeta type, VMeta verb, BatchAbilityConstant ability) {
+      LANGULUS_ASSUME(DevAssumes, type and verb, "Invalid batch ability");
+      {
+         const ::std::unique_lock lock {BatchGuard};
+         GetBatchRecord(type, verb).mConstant = ability;
+      }
+      InvalidateDispatchCache();
+   }
+
+   /// Remove all whole-block abilities for a type and verb                   
+   ///   @param type - the type of the block elements                         
+   ///   @param verb - the verb                                               
+   void UnregisterBatchAbility(DMeta type, VMeta verb) {
+      {
+         const ::std::unique_lock lock {BatchGuard};
+         for (auto i = BatchRegistry.GetCount(); i > 0; --i) {
+            const auto& record = BatchRegistry[i - 1];
+            if (record.mType == type and record.mVerb == verb)
+               BatchRegistry.RemoveIndex(i - 1);
+         }
+      }
+      InvalidateDispatchCache();
+   }
+
+   /// Find a whole-block ability for a mutable block, using the cache        
+   ///   @param type - the type of the block elements                         
+   ///   @param verb - the verb to search for                                 
+   ///   @return the ability, or nullptr if not registered                    
+   BatchAbilityMutable FindBatchAbilityMutable(DMeta type, VMeta verb) noexcept {
+      return FindBatch<true>(BatchMutableCache, type, verb);
+   }
+
+   /// Find a whole-block ability for a constant block, using the cache       
+   ///   @param type - the type of the block elements                         
+   ///   @param verb - the verb to search for                                 
+   ///   @return the ability, or nullptr if not registered                    
+   BatchAbilityConstant FindBatchAbilityConstant(DMeta type, VMeta verb) noexcept {
+      return FindBatch<false>(BatchConstantCache, type, verb);
+   }
+
+   /// Get the small integer id of a type in the static dispatch tables       
+   ///   @param type - the type                                               
+   ///   @return the id, or zero if type has no trampolines registered        
+   Count GetTypeId(DMeta type) noexcept {
+      return FindId(TypeIds, type);
+   }
+
+   /// Get the small integer id of a verb in the static dispatch tables       
+   ///   @param verb - the verb                                               
+   ///   @return the id, or zero if verb has no trampolines registered        
+   Count GetVerbId(VMeta verb) noexcept {
+      return FindId(VerbIds, verb);
+   }
+
+   /// Register statically generated trampolines for a type and verb          
+   /// If the tables are full, the registration is ignored, and the pair      
+   /// is dispatched via RTTI as usual                                        
+   ///   @param type - the type                                               
+   ///   @param verb - the verb                                               
+   ///   @param mutableTrampoline - trampoline for mutable contexts           
+   ///   @param constantTrampoline - trampoline for constant contexts         
+   void RegisterTrampoline(
+      DMeta type, VMeta verb,
+      TrampolineMutable mutableTrampoline,
+      TrampolineConstant constantTrampoline
+   ) {
+      LANGULUS_ASSUME(DevAssumes, type and verb, "Invalid trampoline");
+      const ::std::scoped_lock lock {TableGuard};
+      const auto typeId = AssignId(TypeIds, TypeIdCounter, MaxTypeIds, type);
+      const auto verbId = AssignId(VerbIds, VerbIdCounter, MaxVerbIds, verb);
+      if (not typeId or not verbId)
+         return;
+
+      const auto row = GetRow(typeId);
+      row->mMutable[verbId].store(mutableTrampoline, ::std::memory_order_release);
+      row->mConstant[verbId].store(constantTrampoline, ::std::memory_order_release);
+      InvalidateDispatchCache();
+   }
+
+   /// Find a trampoline for a mutable context                                
+   ///   @param type - the type of the context                                
+   ///   @param verb - the verb                                               
+   ///   @return the trampoline, or nullptr if none was registered            
+   TrampolineMutable FindTrampolineMutable(DMeta type, VMeta verb) noexcept {
+      const auto typeId = GetTypeId(type);
+      if (not typeId)
+         return nullptr;
+      const auto row = Rows[typeId].load(::std::memory_order_acquire);
+      const auto verbId = GetVerbId(verb);
+      if (not row or not verbId)
+         return nullptr;
+      return row->mMutable[verbId].load(::std::memory_order_acquire);
+   }
+
+   /// Find a trampoline for a constant context                               
+   ///   @param type - the type of the context                                
+   ///   @param verb - the verb                                               
+   ///   @return the trampoline, or nullptr if none was registered            
+   TrampolineConstant FindTrampolineConstant(DMeta type, VMeta verb) noexcept {
+      const auto typeId = GetTypeId(type);
+      if (not typeId)
+         return nullptr;
+      const auto row = Rows[typeId].load(::std::memory_order_acquire);
+      const auto verbId = GetVerbId(verb);
+      if (not row or not verbId)
+         return nullptr;
+      return row->mConstant[verbId].load(::std::memory_order_acquire);
+   }
+
+   /// Resolve how to execute a verb with a given argument type in a type.    
+   /// Registered trampolines are found with a two-level array index, and     
+   /// are the same for all arguments. Only types without trampolines search  
+   /// reflected abilities, which is cached, so it's a single probe on hit    
+   ///   @param type - the type of the context                                
+   ///   @param verb - the verb                                               
+   ///   @param argument - the type of the verb argument                      
+   ///   @return the dispatcher, empty if type can't execute the verb         
+   Dispatcher FindDispatcher(DMeta type, VMeta verb, DMeta argument) noexcept {
+      if (not type or not verb)
+         return {};
+
+      // Trampolines resolve argument overloads by themselves, so they  
+      // don't need to be cached for each argument type                 
+      const auto typeId = GetTypeId(type);
+      const auto verbId = GetVerbId(verb);
+      const auto row = typeId ? Rows[typeId].load(::std::memory_order_acquire) : nullptr;
+      if (row and verbId) {
+         Dispatcher dispatcher;
+         dispatcher.mTrampolineMutable = row->mMutable[verbId].load(::std::memory_order_acquire);
+         dispatcher.mTrampolineConstant = row->mConstant[verbId].load(::std::memory_order_acquire);
+         if (dispatcher.mTrampolineMutable or dispatcher.mTrampolineConstant)
+            return dispatcher;
+      }
+
+      const auto generation = Generation.load(::std::memory_order_acquire);
+      const auto reflected = ReflectedAbilities(type);
+      auto& entry = DispatcherCache[HashOf(type, verb, argument).mHash & (CacheSize - 1)];
+      if (entry.mGeneration == generation and entry.mReflected == reflected
+      and entry.mType == type and entry.mVerb == verb and entry.mArgument == argument)
+         return entry.mDispatcher;
+
+      entry.mType = type;
+      entry.mVerb = verb;
+      entry.mArgument = argument;
+      entry.mGeneration = generation;
+      entry.mReflected = reflected;
+
+      // Reflected abilities might be overloaded for different          
+      // arguments, so they're searched with the argument type          
+      auto& dispatcher = entry.mDispatcher;
+      dispatcher = {};
+      dispatcher.mAbilityMutable = type->template GetAbility<true>(verb, argument);
+      dispatcher.mAbilityConstant = type->template GetAbility<false>(verb, argument);
+      return dispatcher;
+   }
+
+   /// Check if a type can execute a verb in any way - via reflected          
+   /// abilities, static trampolines, or whole-block abilities. The slow      
+   /// check is done only the first time a pair is queried - afterwards this  
+   /// is a single load, until reflected abilities change. Querying never     
+   /// assigns ids or allocates rows - pairs that weren't registered in the   
+   /// tables are cached per thread instead                                   
+   ///   @param type - the type                                               
+   ///   @param verb - the verb                                               
+   ///   @return true if type has some kind of ability for verb               
+   bool IsAvailable(DMeta type, VMeta verb) {
+      if (not type or not verb)
+         return false;
+
+      // Load the generation before computing anything, so that results 
+      // computed while abilities change are tagged as outdated         
+      auto generation = Generation.load(::std::memory_order_acquire);
+      const auto reflected = ReflectedAbilities(type);
+      const auto typeId = GetTypeId(type);
+      const auto verbId = GetVerbId(verb);
+      const auto row = typeId ? Rows[typeId].load(::std::memory_order_acquire) : nullptr;
+      if (not row or not verbId) {
+         auto& entry = AvailabilityCache[HashOf(type, verb).mHash & (CacheSize - 1)];
+         if (entry.mGeneration == generation and entry.mReflected == reflected
+         and entry.mType == type and entry.mVerb == verb)
+            return entry.mAvailable;
+
+         entry.mType = type;
+         entry.mVerb = verb;
+         entry.mGeneration = generation;
+         entry.mReflected = reflected;
+         entry.mAvailable = ComputeAvailability(type, verb);
+         return entry.mAvailable;
+      }
+
+      // The row is shared by all verbs of the type, so abilities that  
+      // were reflected since it was filled invalidate all caches       
+      if (row->mReflected.exchange(reflected, ::std::memory_order_acq_rel) != reflected) {
+         InvalidateDispatchCache();
+         generation = Generation.load(::std::memory_order_acquire);
+      }
+
+      auto& slot = row->mAvailability[verbId];
+      const auto known = slot.load(::std::memory_order_acquire);
+      if ((known >> GenerationShift) == TagAvailability(generation, false) >> GenerationShift)
+         return known & AvailableBit;
+
+      const bool available = ComputeAvailability(type, verb);
+      slot.store(TagAvailability(generation, available), ::std::memory_order_release);
+      return available;
+   }
+
+   /// Mark a verb as safe for parallel dispatch. Thread-safe verbs must not  
+   /// touch anything outside their context and argument, in which case       
+   /// large deep contexts are split across worker threads. If the verb       
+   /// tables are full, the verb is never considered thread-safe              
+   ///   @param verb - the verb                                               
+   ///   @param safe - whether or not the verb is thread-safe                 
+   void MarkThreadSafe(VMeta verb, bool safe) {
+      LANGULUS_ASSUME(DevAssumes, verb, "Invalid verb");
+      const ::std::scoped_lock lock {TableGuard};
+      const auto verbId = AssignId(VerbIds, VerbIdCounter, MaxVerbIds, verb);
+      if (verbId)
+         ThreadSafeVerbs[verbId].store(safe, ::std::memory_order_release);
+   }
+
+   /// Check if a verb is safe for parallel dispatch, without locking         
+   ///   @param verb - the verb                                               
+   ///   @return true if verb was marked thread-safe                          
+   bool IsThreadSafe(VMeta verb) noexcept {
+      const auto verbId = GetVerbId(verb);
+      return verbId and ThreadSafeVerbs[verbId].load(::std::memory_order_acquire);
+   }
+
+} // namespace Langulus::Flow::Inner
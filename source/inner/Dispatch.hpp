@@ -0,0 +1,153 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../Verb.hpp"
+#include <type_traits>
+
+
+namespace Langulus::Flow::Inner
+{
+
+   /// Reflected ability and converter function types                         
+   using AbilityMutable = decltype(
+      DMeta {}->template GetAbility<true>(VMeta {}, DMeta {}));
+   using AbilityConstant = decltype(
+      DMeta {}->template GetAbility<false>(VMeta {}, DMeta {}));
+   using Converter = decltype(DMeta {}->GetConverter(DMeta {}));
+
+   template<bool MUTABLE>
+   using Ability = ::std::conditional_t<MUTABLE, AbilityMutable, AbilityConstant>;
+
+   NOD() LANGULUS_API(FLOW)
+   AbilityMutable FindAbilityMutable(DMeta, VMeta, DMeta) noexcept;
+   NOD() LANGULUS_API(FLOW)
+   AbilityConstant FindAbilityConstant(DMeta, VMeta, DMeta) noexcept;
+   NOD() LANGULUS_API(FLOW)
+   Converter FindConverter(DMeta, DMeta) noexcept;
+
+   LANGULUS_API(FLOW) void InvalidateDispatchCache() noexcept;
+
+   /// Whole-block abilities, that execute a verb for all elements of a flat  
+   /// dense block at once. They must either succeed for all elements, and    
+   /// mark the verb done, or fail for all of them - in that case, the        
+   /// dispatcher falls back to executing the verb element by element         
+   using BatchAbilityMutable  = void(*)(Many&, Verb&);
+   using BatchAbilityConstant = void(*)(const Many&, Verb&);
+
+   template<bool MUTABLE>
+   using BatchAbility = ::std::conditional_t<MUTABLE, BatchAbilityMutable, BatchAbilityConstant>;
+
+   LANGULUS_API(FLOW) void RegisterBatchAbility(DMeta, VMeta, BatchAbilityMutable);
+   LANGULUS_API(FLOW) void RegisterBatchAbility(DMeta, VMeta, BatchAbilityConstant);
+   LANGULUS_API(FLOW) void UnregisterBatchAbility(DMeta, VMeta);
+
+   NOD() LANGULUS_API(FLOW)
+   BatchAbilityMutable FindBatchAbilityMutable(DMeta, VMeta) noexcept;
+   NOD() LANGULUS_API(FLOW)
+   BatchAbilityConstant FindBatchAbilityConstant(DMeta, VMeta) noexcept;
+
+   /// Statically generated trampolines, that invoke a verb's compile-time    
+   /// execution routine for a specific type - see TVerb::RegisterDispatch    
+   using TrampolineMutable  = bool(*)(void*, Verb&);
+   using TrampolineConstant = bool(*)(const void*, Verb&);
+
+   NOD() LANGULUS_API(FLOW) Count GetTypeId(DMeta) noexcept;
+   NOD() LANGULUS_API(FLOW) Count GetVerbId(VMeta) noexcept;
+
+   LANGULUS_API(FLOW)
+   void RegisterTrampoline(DMeta, VMeta, TrampolineMutable, TrampolineConstant);
+
+   NOD() LANGULUS_API(FLOW)
+   TrampolineMutable FindTrampolineMutable(DMeta, VMeta) noexcept;
+   NOD() LANGULUS_API(FLOW)
+   TrampolineConstant FindTrampolineConstant(DMeta, VMeta) noexcept;
+
+   NOD() LANGULUS_API(FLOW) bool IsAvailable(DMeta, VMeta);
+
+   ///                                                                        
+   ///   Everything needed to execute a verb with a given argument type in a  
+   /// given type, resolved at once. Statically generated trampolines are the 
+   /// primary path, and they resolve argument overloads by themselves, so    
+   /// reflected abilities are searched only for types without trampolines    
+   ///                                                                        
+   struct Dispatcher {
+      AbilityMutable mAbilityMutable {};
+      AbilityConstant mAbilityConstant {};
+      TrampolineMutable mTrampolineMutable {};
+      TrampolineConstant mTrampolineConstant {};
+   };
+
+   NOD() LANGULUS_API(FLOW)
+   Dispatcher FindDispatcher(DMeta, VMeta, DMeta) noexcept;
+
+   /// Deep contexts with at least this many subblocks are dispatched in      
+   /// parallel, if the verb is marked thread-safe                            
+   constexpr Count ParallelDispatchThreshold = 64;
+
+   LANGULUS_API(FLOW) void MarkThreadSafe(VMeta, bool = true);
+   NOD() LANGULUS_API(FLOW) bool IsThreadSafe(VMeta) noexcept;
+
+   /// Mark a statically known verb as safe for parallel dispatch             
+   ///   @tparam V - the verb                                                 
+   ///   @param safe - whether or not the verb is thread-safe                 
+   template<CT::Verb V> LANGULUS(INLINED)
+   void MarkThreadSafe(bool safe = true) {
+      MarkThreadSafe(MetaVerbOf<V>(), safe);
+   }
+
+   /// Find a reflected ability, using the dispatch cache                     
+   ///   @tparam MUTABLE - whether the context is mutable                     
+   ///   @param type - the type of the context                                
+   ///   @param verb - the verb to search for                                 
+   ///   @param argument - the type of the verb argument                      
+   ///   @return the ability, or nullptr if not reflected                     
+   template<bool MUTABLE> LANGULUS(INLINED)
+   Ability<MUTABLE> FindAbility(DMeta type, VMeta verb, DMeta argument) noexcept {
+      if constexpr (MUTABLE)
+         return FindAbilityMutable(type, verb, argument);
+      else
+         return FindAbilityConstant(type, verb, argument);
+   }
+
+   /// Find a whole-block ability, using the dispatch cache                   
+   ///   @tparam MUTABLE - whether the block is mutable                       
+   ///   @param type - the type of the block elements                         
+   ///   @param verb - the verb to search for                                 
+   ///   @return the batch ability, or nullptr if none was registered         
+   template<bool MUTABLE> LANGULUS(INLINED)
+   BatchAbility<MUTABLE> FindBatchAbility(DMeta type, VMeta verb) noexcept {
+      if constexpr (MUTABLE)
+         return FindBatchAbilityMutable(type, verb);
+      else
+         return FindBatchAbilityConstant(type, verb);
+   }
+
+   /// Register a whole-block ability for a statically known type and verb    
+   ///   @tparam T - the type of the elements                                 
+   ///   @tparam V - the verb                                                 
+   ///   @tparam F - the function, taking a TMany<T> and the verb - the       
+   ///      block is constant, if the function accepts a constant block       
+   template<CT::Data T, CT::Verb V, auto F>
+   void RegisterBatchAbility() {
+      if constexpr (requires (TMany<T>& b, Verb& v) { F(b, v); }) {
+         RegisterBatchAbility(MetaDataOf<T>(), MetaVerbOf<V>(),
+            static_cast<BatchAbilityMutable>([](Many& block, Verb& verb) {
+               F(reinterpret_cast<TMany<T>&>(block), verb);
+            })
+         );
+      }
+      else {
+         RegisterBatchAbility(MetaDataOf<T>(), MetaVerbOf<V>(),
+            static_cast<BatchAbilityConstant>([](const Many& block, Verb& verb) {
+               F(reinterpret_cast<const TMany<T>&>(block), verb);
+            })
+         );
+      }
+   }
+
+} // namespace Langulus::Flow::Inner
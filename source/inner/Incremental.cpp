@@ -0,0 +1,156 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Incremental.hpp"
+#include "Missing.hpp"
+#include "../Memo.hpp"
+
+
+namespace Langulus::Flow::Inner
+{
+   namespace
+   {
+
+      /// The cache, installed in the current thread                          
+      thread_local Incremental* Active = nullptr;
+
+      bool IsStable(const A::Verb&, bool contextStable);
+
+      /// Check if a scope always integrates to the same result               
+      ///   @param scope - the scope to check                                 
+      ///   @param contextStable - whether the context, in which scope is     
+      ///      integrated, is always the same                                 
+      ///   @return true if scope is stable                                   
+      bool IsStable(const Many& scope, const bool contextStable) {
+         if (scope.IsDeep()) {
+            // Sparse scopes act as handles, that can change externally 
+            if (scope.IsSparse())
+               return false;
+
+            bool stable = true;
+            scope.ForEach([&](const Many& subscope) {
+               stable = IsStable(subscope, contextStable);
+               return stable ? Loop::Continue : Loop::Break;
+            });
+            return stable;
+         }
+
+         bool stable = true;
+         scope.ForEach(
+            [&](const A::Verb& verb) {
+               stable = IsStable(verb, contextStable);
+               return stable ? Loop::Continue : Loop::Break;
+            },
+            [&](const Missing& missing) {
+               stable = IsStable(missing.mContent, contextStable);
+               return stable ? Loop::Continue : Loop::Break;
+            },
+            [&](const Trait& trait) {
+               stable = IsStable(trait, contextStable);
+               return stable ? Loop::Continue : Loop::Break;
+            },
+            [&](const Construct&) {
+               // Constructs might produce new instances each time      
+               stable = false;
+               return Loop::Break;
+            },
+            [&](const Neat&) {
+               // Neats might contain verbs - be conservative           
+               stable = false;
+               return Loop::Break;
+            }
+         );
+         return stable;
+      }
+
+      /// Check if a verb always produces the same output                     
+      ///   @param verb - the verb to check                                   
+      ///   @param contextStable - whether the context, in which verb is      
+      ///      executed, is always the same                                   
+      ///   @return true if verb is stable                                    
+      bool IsStable(const A::Verb& verb, const bool contextStable) {
+         if (not Memo::IsPure(verb.GetVerb()))
+            return false;
+
+         // Verbs without a source are executed in the context, and the 
+         // argument is always integrated in the source                 
+         const auto& source = verb.GetSource();
+         const bool sourceStable = source
+            ? IsStable(source, contextStable)
+            : contextStable;
+         return sourceStable and IsStable(verb.GetArgument(), sourceStable);
+      }
+
+   } // namespace Langulus::Flow::Inner::<anonymous>
+
+
+   /// Copying a cache yields an empty one, because it belongs to another flow
+   ///   @return a reference to this cache                                    
+   Incremental& Incremental::operator = (const Incremental&) noexcept {
+      mEntries.clear();
+      return *this;
+   }
+
+   /// Reuse the output of a stable verb from a previous execution            
+   ///   @param verb - the verb inside the flow                               
+   ///   @param output - [out] the reused output is pushed here               
+   ///   @return true if verb was recalled, and doesn't need executing        
+   bool Incremental::Recall(const A::Verb& verb, Many& output) const {
+      const auto found = mEntries.find(&verb);
+      if (found == mEntries.end() or not found->second.mStable)
+         return false;
+
+      output.SmartPush(IndexBack, Abandon(Many {found->second.mOutput}));
+      return true;
+   }
+
+   /// Remember an executed verb, along with its output, if it is stable      
+   ///   @param verb - the verb inside the flow                               
+   ///   @param output - the output it produced                               
+   ///   @param context - the context it was executed in; only verbs in an    
+   ///      empty context are considered stable, unless they have a source    
+   void Incremental::Remember(
+      const A::Verb& verb, const Many& output, const Many& context
+   ) {
+      // Stability is checked only once per verb                        
+      if (mEntries.contains(&verb))
+         return;
+
+      const bool stable = IsStable(verb, not context);
+      mEntries.emplace(&verb, Entry {stable ? output : Many {}, stable});
+   }
+
+   /// Forget all executed verbs, must be done whenever the flow changes      
+   void Incremental::Reset() noexcept {
+      mEntries.clear();
+   }
+
+   /// Get the number of remembered verbs                                     
+   ///   @return the number of verbs, stable or not                           
+   Count Incremental::GetCount() const noexcept {
+      return mEntries.size();
+   }
+
+   /// Get the cache, installed in the current thread                         
+   ///   @return the cache, or nullptr if none is installed                   
+   Incremental* Incremental::GetActive() noexcept {
+      return Active;
+   }
+
+   /// Install a cache for the current thread                                 
+   ///   @param cache - the cache to install, or nullptr to disable caching   
+   Incremental::Scope::Scope(Incremental* cache) noexcept
+      : mPrevious {Active} {
+      Active = cache;
+   }
+
+   /// Restore the previously installed cache                                 
+   Incremental::Scope::~Scope() {
+      Active = mPrevious;
+   }
+
+} // namespace Langulus::Flow::Inner
@@ -0,0 +1,80 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../Common.hpp"
+#include <unordered_map>
+
+
+namespace Langulus::Flow::Inner
+{
+
+   ///                                                                        
+   ///   Cached outputs of the stable verbs in a periodic flow                
+   ///                                                                        
+   ///   A verb is stable, if it is pure, and its source and argument always  
+   /// integrate to the same result - they contain no sparse handles,         
+   /// constructs or neats, and all verbs inside them are stable, too. Stable 
+   /// verbs are executed on the first tick of a periodic flow, and their     
+   /// outputs are reused on the following ticks, without integrating them    
+   /// again. Time-dependent verbs are never pure, so they, and all verbs     
+   /// that consume their outputs, are executed on every tick.                
+   ///   Verbs are identified by their place inside the flow, so the cache    
+   /// must be reset whenever the flow changes. Copies of a cache are always  
+   /// empty, because they belong to another flow.                            
+   ///                                                                        
+   class Incremental {
+   public:
+      class Scope;
+
+   private:
+      /// A verb that was executed at least once                              
+      struct Entry {
+         // The output of the verb, if stable                           
+         Many mOutput;
+         // Whether the output can be reused                            
+         bool mStable;
+      };
+
+      // Executed verbs, keyed by their place in the flow               
+      ::std::unordered_map<const A::Verb*, Entry> mEntries;
+
+   public:
+      Incremental() = default;
+      Incremental(const Incremental&) noexcept {}
+      Incremental(Incremental&&) noexcept = default;
+
+      LANGULUS_API(FLOW) Incremental& operator = (const Incremental&) noexcept;
+      Incremental& operator = (Incremental&&) noexcept = default;
+
+      LANGULUS_API(FLOW) bool Recall(const A::Verb&, Many& output) const;
+      LANGULUS_API(FLOW) void Remember(const A::Verb&, const Many& output, const Many& context);
+      LANGULUS_API(FLOW) void Reset() noexcept;
+
+      NOD() LANGULUS_API(FLOW) Count GetCount() const noexcept;
+      NOD() LANGULUS_API(FLOW) static Incremental* GetActive() noexcept;
+   };
+
+
+   ///                                                                        
+   ///   Installs a cache for all verb executions in the current thread,      
+   /// until destroyed. Each periodic flow installs its own cache, so inner   
+   /// scopes always override outer ones                                      
+   ///                                                                        
+   class Incremental::Scope {
+      Incremental* mPrevious;
+
+   public:
+      Scope() = delete;
+      Scope(const Scope&) = delete;
+      Scope(Scope&&) = delete;
+
+      LANGULUS_API(FLOW) Scope(Incremental*) noexcept;
+      LANGULUS_API(FLOW) ~Scope();
+   };
+
+} // namespace Langulus::Flow::Inner
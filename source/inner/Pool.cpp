@@ -0,0 +1,122 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Pool.hpp"
+
+
+namespace Langulus::Flow::Inner
+{
+   namespace
+   {
+
+      /// Maximum number of containers kept in each thread's pool             
+      constexpr Count MaxPooled = 32;
+
+      /// Cleared output containers, that still own their memory. Each        
+      /// thread has its own pool, so no locking is required                  
+      thread_local TMany<Many> Pooled;
+      thread_local OutputPoolStatistics Statistics;
+
+   } // namespace Langulus::Flow::Inner::<anonymous>
+
+
+   /// Get an empty output container for a dispatch level, preferably one     
+   /// from the pool, that already has enough memory reserved                 
+   ///   @param like - container, whose state is carried to the output        
+   ///   @param type - the type of the outputs that will be pushed            
+   ///   @param reserve - the number of elements to make room for             
+   ///   @return the output container                                         
+   Many AcquireOutput(const Many& like, DMeta type, Count reserve) {
+      ++Statistics.mAcquired;
+      const auto state = like.GetState();
+
+      for (auto i = Pooled.GetCount(); i > 0; --i) {
+         if (not Pooled[i - 1].IsExact(type))
+            continue;
+
+         Many result = Move(Pooled[i - 1]);
+         Pooled.RemoveIndex(i - 1);
+         result.SetState(state);
+         result.Reserve(reserve);
+         ++Statistics.mReused;
+         return result;
+      }
+
+      auto result = Many::FromMeta(type, state);
+      result.Reserve(reserve);
+      return result;
+   }
+
+   /// Return an output container to the pool, if it's the only owner of      
+   /// its memory - otherwise it is simply reset                              
+   ///   @param output - the container to recycle, will be empty afterwards   
+   void RecycleOutput(Many& output) {
+      if (not output.IsAllocated() or output.GetUses() != 1
+      or output.IsSparse() or Pooled.GetCount() >= MaxPooled) {
+         output.Reset();
+         return;
+      }
+
+      output.Clear();
+      Pooled << Move(output);
+      output.Reset();
+      ++Statistics.mRecycled;
+   }
+
+   /// Merge the output of a dispatch branch into the output of a dispatch    
+   /// level. Dense POD outputs of the same type are copied into a pooled     
+   /// container, and the branch's container goes back to the pool, so        
+   /// that deep dispatches don't allocate a new container at each level.     
+   /// Many AND outputs of the branches of an OR level are never copied, so   
+   /// that each branch remains a separate alternative                        
+   ///   @param output - the output of the dispatch level, initially an       
+   ///      empty container with the state of the dispatched context          
+   ///   @param branch - the output of the branch, empty afterwards           
+   ///   @param reserve - the number of elements expected in the output       
+   void MergeOutput(Many& output, Many& branch, Count reserve) {
+      const auto type = branch.GetType();
+      const bool poolable = type and type->mIsPOD and branch.IsDense()
+         and not branch.IsDeep() and not branch.IsOr()
+         and (not output.IsOr() or branch.GetCount() < 2);
+
+      if (poolable and not output) {
+         if (not output.GetType() or output.IsExact(type)) {
+            output = AcquireOutput(output, type, reserve);
+            output.SmartPush(IndexBack, Refer(branch));
+            RecycleOutput(branch);
+            return;
+         }
+      }
+      else if (poolable and output.IsExact(type) and not output.IsDeep()) {
+         output.SmartPush(IndexBack, Refer(branch));
+         RecycleOutput(branch);
+         return;
+      }
+
+      // Cache output, conserving the context hierarchy. Once the       
+      // first output determines the output type, make room for the rest
+      // in a single allocation - OR contexts usually stop early        
+      const bool first = not output;
+      output.SmartPush(IndexBack, Move(branch));
+      if (first and not output.IsOr() and output.GetCount() < reserve)
+         output.Reserve(reserve);
+   }
+
+   /// Get the statistics of the output pool in the current thread            
+   ///   @return the statistics                                               
+   const OutputPoolStatistics& GetOutputPoolStatistics() noexcept {
+      return Statistics;
+   }
+
+   /// Release all pooled containers in the current thread, and reset         
+   /// the statistics                                                         
+   void ClearOutputPool() {
+      Pooled.Reset();
+      Statistics = {};
+   }
+
+} // namespace Langulus::Flow::Inner
@@ -0,0 +1,38 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../Common.hpp"
+
+
+namespace Langulus::Flow::Inner
+{
+
+   ///                                                                        
+   ///   Statistics of the output pool in the current thread                  
+   ///                                                                        
+   struct OutputPoolStatistics {
+      // Number of output containers requested by dispatchers           
+      Count mAcquired {};
+      // Number of requests satisfied by a pooled container             
+      Count mReused {};
+      // Number of containers returned to the pool                      
+      Count mRecycled {};
+   };
+
+   NOD() LANGULUS_API(FLOW)
+   Many AcquireOutput(const Many& state, DMeta type, Count reserve);
+   LANGULUS_API(FLOW)
+   void RecycleOutput(Many&);
+   LANGULUS_API(FLOW)
+   void MergeOutput(Many& output, Many& branch, Count reserve);
+
+   NOD() LANGULUS_API(FLOW)
+   const OutputPoolStatistics& GetOutputPoolStatistics() noexcept;
+   LANGULUS_API(FLOW) void ClearOutputPool();
+
+} // namespace Langulus::Flow::Inner
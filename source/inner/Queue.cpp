@@ -0,0 +1,98 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Queue.hpp"
+
+
+namespace Langulus::Flow::Inner
+{
+
+   /// Move the pending scopes of another queue                               
+   ///   @attention no other thread may push to either queue while moving     
+   ///   @param other - the queue to move                                     
+   ScopeQueue::ScopeQueue(ScopeQueue&& other) noexcept
+      : mHead {other.mHead.exchange(nullptr, ::std::memory_order_acquire)} {}
+
+   /// Destroy any pending scopes                                             
+   ScopeQueue::~ScopeQueue() {
+      Clear();
+   }
+
+   /// Copying a queue discards the pending scopes, because they belong to    
+   /// the original owner                                                     
+   ///   @return a reference to this queue                                    
+   ScopeQueue& ScopeQueue::operator = (const ScopeQueue&) noexcept {
+      Clear();
+      return *this;
+   }
+
+   /// Discard the pending scopes, and take the ones of another queue         
+   ///   @attention no other thread may push to either queue while moving     
+   ///   @param other - the queue to move                                     
+   ///   @return a reference to this queue                                    
+   ScopeQueue& ScopeQueue::operator = (ScopeQueue&& other) noexcept {
+      if (this != &other) {
+         Clear();
+         mHead.store(
+            other.mHead.exchange(nullptr, ::std::memory_order_acquire),
+            ::std::memory_order_release
+         );
+      }
+      return *this;
+   }
+
+   /// Destroy all pending scopes                                             
+   void ScopeQueue::Clear() noexcept {
+      auto node = mHead.exchange(nullptr, ::std::memory_order_acquire);
+      while (node) {
+         const auto next = node->mNext;
+         delete node;
+         node = next;
+      }
+   }
+
+   /// Push a scope to the queue, can be called from any thread               
+   ///   @attention the scope must not be shared with other threads           
+   ///   @param scope - the scope to push                                     
+   void ScopeQueue::Push(Many&& scope) {
+      auto node = new Node {Move(scope), mHead.load(::std::memory_order_relaxed)};
+      while (not mHead.compare_exchange_weak(node->mNext, node,
+         ::std::memory_order_release, ::std::memory_order_relaxed));
+   }
+
+   /// Detach all pending scopes, must be called only by the owner            
+   ///   @return a deep container with the scopes, in the order they were     
+   ///      pushed, or an empty container if nothing was pending              
+   Many ScopeQueue::Drain() {
+      auto node = mHead.exchange(nullptr, ::std::memory_order_acquire);
+
+      // The list starts with the most recent scope, so reverse it      
+      Node* first = nullptr;
+      while (node) {
+         const auto next = node->mNext;
+         node->mNext = first;
+         first = node;
+         node = next;
+      }
+
+      Many scopes;
+      while (first) {
+         const auto next = first->mNext;
+         scopes << Abandon(first->mScope);
+         delete first;
+         first = next;
+      }
+      return scopes;
+   }
+
+   /// Check if there are any pending scopes                                  
+   ///   @return true if nothing is pending                                   
+   bool ScopeQueue::IsEmpty() const noexcept {
+      return not mHead.load(::std::memory_order_relaxed);
+   }
+
+} // namespace Langulus::Flow::Inner
@@ -0,0 +1,52 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../Common.hpp"
+#include <atomic>
+
+
+namespace Langulus::Flow::Inner
+{
+
+   ///                                                                        
+   ///   Lock-free multi-producer single-consumer queue of scopes             
+   ///                                                                        
+   ///   Any thread can push scopes, but only the owner drains them. Pushing  
+   /// is a single compare-and-swap on the head of an intrusive list, and     
+   /// draining detaches the whole list at once, so nodes are never reused    
+   /// while other threads might still see them.                              
+   ///   Copies of a queue are always empty, because the pending scopes       
+   /// belong to the original owner.                                          
+   ///                                                                        
+   class ScopeQueue {
+      /// A pending scope                                                     
+      struct Node {
+         Many mScope;
+         Node* mNext;
+      };
+
+      // The most recently pushed scope                                 
+      ::std::atomic<Node*> mHead {};
+
+      void Clear() noexcept;
+
+   public:
+      ScopeQueue() = default;
+      ScopeQueue(const ScopeQueue&) noexcept {}
+      LANGULUS_API(FLOW) ScopeQueue(ScopeQueue&&) noexcept;
+      LANGULUS_API(FLOW) ~ScopeQueue();
+
+      LANGULUS_API(FLOW) ScopeQueue& operator = (const ScopeQueue&) noexcept;
+      LANGULUS_API(FLOW) ScopeQueue& operator = (ScopeQueue&&) noexcept;
+
+      LANGULUS_API(FLOW) void Push(Many&&);
+      NOD() LANGULUS_API(FLOW) Many Drain();
+      NOD() LANGULUS_API(FLOW) bool IsEmpty() const noexcept;
+   };
+
+} // namespace Langulus::Flow::Inner
@@ -0,0 +1,236 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Workers.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace Langulus::Flow::Inner
+{
+   namespace
+   {
+
+      ///                                                                     
+      ///   A lazily started pool of worker threads, shared by all parallel   
+      /// executions. Threads are joined when the library is unloaded         
+      ///                                                                     
+      ///   Each worker has its own queue - it takes its newest job first,    
+      /// and when its queue runs dry, it steals the oldest jobs of the       
+      /// other workers. Jobs enqueued from inside a worker go to its own     
+      /// queue, so nested parallel executions stay local, unless somebody    
+      /// is idle and steals them                                             
+      ///                                                                     
+      class Pool {
+         using Task = ::std::function<void()>;
+
+         struct Queue {
+            ::std::mutex mMutex;
+            TMany<Task> mTasks;
+         };
+
+         ::std::vector<::std::thread> mThreads;
+         ::std::unique_ptr<Queue[]> mQueues;
+         Count mQueueCount;
+         ::std::atomic<Count> mPending {};
+         ::std::atomic<Count> mNextQueue {};
+         ::std::mutex mMutex;
+         ::std::condition_variable mSignal;
+         bool mStopping {};
+
+         /// Index of the worker's own queue, or the queue count for          
+         /// threads that don't belong to the pool                            
+         static inline thread_local Count Self = ::std::numeric_limits<Count>::max();
+
+      public:
+         Pool() {
+            const auto count = ::std::max(1u, ::std::thread::hardware_concurrency()) - 1;
+            mQueueCount = ::std::max(count, 1u);
+            mQueues = ::std::make_unique<Queue[]>(mQueueCount);
+            mThreads.reserve(count);
+            for (unsigned i = 0; i < count; ++i)
+               mThreads.emplace_back([this, i] { Work(i); });
+         }
+
+         ~Pool() {
+            {
+               const ::std::scoped_lock lock {mMutex};
+               mStopping = true;
+            }
+
+            mSignal.notify_all();
+            for (auto& thread : mThreads)
+               thread.join();
+         }
+
+         Count GetThreadCount() const noexcept {
+            return mThreads.size();
+         }
+
+         void Enqueue(Task&& job) {
+            const auto index = Self < mQueueCount ? Self
+               : mNextQueue.fetch_add(1, ::std::memory_order_relaxed) % mQueueCount;
+
+            // Count the job before publishing it, so that a worker that
+            // takes it right away never decrements below zero. Do it   
+            // under the sleeping mutex, so that a worker that is just  
+            // about to sleep doesn't miss the signal                   
+            {
+               const ::std::scoped_lock lock {mMutex};
+               mPending.fetch_add(1, ::std::memory_order_relaxed);
+            }
+
+            {
+               auto& queue = mQueues[index];
+               const ::std::scoped_lock lock {queue.mMutex};
+               queue.mTasks << ::std::move(job);
+            }
+            mSignal.notify_one();
+         }
+
+      private:
+         /// Take the newest job from own queue, or steal the oldest job      
+         /// from another worker                                              
+         bool TryTake(const Count self, Task& job) {
+            for (Count i = 0; i < mQueueCount; ++i) {
+               auto& queue = mQueues[(self + i) % mQueueCount];
+               const ::std::scoped_lock lock {queue.mMutex};
+               if (not queue.mTasks)
+                  continue;
+
+               const auto index = i == 0 ? queue.mTasks.GetCount() - 1 : 0;
+               job = ::std::move(queue.mTasks[index]);
+               queue.mTasks.RemoveIndex(index);
+
+               mPending.fetch_sub(1, ::std::memory_order_relaxed);
+               return true;
+            }
+
+            return false;
+         }
+
+         void Work(const Count self) {
+            Self = self;
+            while (true) {
+               Task job;
+               if (TryTake(self, job)) {
+                  job();
+                  continue;
+               }
+
+               ::std::unique_lock lock {mMutex};
+               mSignal.wait(lock, [this] {
+                  return mStopping
+                      or mPending.load(::std::memory_order_acquire) > 0;
+               });
+
+               if (mStopping and mPending.load(::std::memory_order_acquire) == 0)
+                  return;
+            }
+         }
+      };
+
+      Pool& GetPool() {
+         static Pool pool;
+         return pool;
+      }
+
+      /// State shared between the caller and the helpers of a single         
+      /// ParallelFor. Helpers that start late, after all chunks have been    
+      /// claimed, don't touch anything but this state, so the caller never   
+      /// has to wait for them to start - that makes nesting deadlock-free    
+      struct Batch {
+         const Job* mJob;
+         Count mCount;
+         Count mChunk;
+         Count mChunks;
+         ::std::atomic<Count> mNext {};
+         ::std::atomic<Count> mDone {};
+         ::std::mutex mMutex;
+         ::std::condition_variable mSignal;
+         ::std::exception_ptr mException;
+
+         /// Claim and process chunks until none are left                     
+         void Run() {
+            while (true) {
+               const auto chunk = mNext.fetch_add(1, ::std::memory_order_relaxed);
+               if (chunk >= mChunks)
+                  return;
+
+               const auto from = chunk * mChunk;
+               const auto to = ::std::min(from + mChunk, mCount);
+               try { (*mJob)(from, to); }
+               catch (...) {
+                  const ::std::scoped_lock lock {mMutex};
+                  if (not mException)
+                     mException = ::std::current_exception();
+               }
+
+               if (mDone.fetch_add(1, ::std::memory_order_acq_rel) + 1 == mChunks) {
+                  const ::std::scoped_lock lock {mMutex};
+                  mSignal.notify_all();
+               }
+            }
+         }
+      };
+
+   } // namespace Langulus::Flow::Inner::<anonymous>
+
+
+   /// Get the number of threads that execute in parallel, including the      
+   /// calling one                                                            
+   ///   @return the number of threads                                        
+   Count GetWorkerCount() noexcept {
+      return GetPool().GetThreadCount() + 1;
+   }
+
+   /// Split a range in chunks, and process them in parallel. The calling     
+   /// thread participates, and returns after all chunks are processed        
+   /// Exceptions are propagated to the caller (the first one only)           
+   ///   @param count - the number of elements to process                     
+   ///   @param chunk - the number of elements in each chunk                  
+   ///   @param job - the function that processes a chunk                     
+   void ParallelFor(const Count count, Count chunk, const Job& job) {
+      if (not count)
+         return;
+
+      chunk = ::std::max(chunk, Count {1});
+      const auto chunks = (count + chunk - 1) / chunk;
+      if (chunks == 1) {
+         job(0, count);
+         return;
+      }
+
+      auto batch = ::std::make_shared<Batch>();
+      batch->mJob = &job;
+      batch->mCount = count;
+      batch->mChunk = chunk;
+      batch->mChunks = chunks;
+
+      auto& pool = GetPool();
+      const auto helpers = ::std::min(chunks - 1, pool.GetThreadCount());
+      for (Count i = 0; i < helpers; ++i)
+         pool.Enqueue([batch] { batch->Run(); });
+
+      batch->Run();
+
+      ::std::unique_lock lock {batch->mMutex};
+      batch->mSignal.wait(lock, [&] {
+         return batch->mDone.load(::std::memory_order_acquire) == chunks;
+      });
+
+      if (batch->mException)
+         ::std::rethrow_exception(batch->mException);
+   }
+
+} // namespace Langulus::Flow::Inner
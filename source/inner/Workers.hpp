@@ -0,0 +1,23 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#pragma once
+#include "../Common.hpp"
+#include <functional>
+
+
+namespace Langulus::Flow::Inner
+{
+
+   /// A job, that processes the elements in the range [from, to)             
+   using Job = ::std::function<void(Count from, Count to)>;
+
+   NOD() LANGULUS_API(FLOW) Count GetWorkerCount() noexcept;
+
+   LANGULUS_API(FLOW) void ParallelFor(Count count, Count chunk, const Job&);
+
+} // namespace Langulus::Flow::Inner
@@ -56,8 +56,17 @@ namespace Langulus::Flow
    {
       template<bool DISPATCH, bool DEFAULT, bool FALLBACK, class BASE>
       Count ExecuteInBases(CT::Data auto&, CT::VerbBased auto&);
+
+      template<bool RESOLVE, bool DISPATCH, bool DEFAULT>
+      Count DispatchParallel(CT::Deep auto&, CT::VerbBased auto&);
+
+      template<bool RESOLVE, bool DISPATCH, bool DEFAULT>
+      Count DispatchDeep(CT::Deep auto&, CT::VerbBased auto&);
    }
 
+   template<bool RESOLVE = true>
+   Count DispatchBatch(CT::Deep auto&, CT::VerbBased auto&);
+
    template<bool RESOLVE = true, bool DISPATCH = true, bool DEFAULT = true>
    Count DispatchFlat(CT::Deep auto&, CT::VerbBased auto&);
 
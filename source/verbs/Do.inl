@@ -8,6 +8,11 @@
 #pragma once
 #include "Do.hpp"
 #include "../TVerb.inl"
+#include "../Profiler.hpp"
+#include "../inner/Dispatch.hpp"
+#include "../inner/Workers.hpp"
+#include "../inner/Pool.hpp"
+#include "../Executor.hpp"
 
 
 namespace Langulus::Verbs
@@ -170,6 +175,75 @@ namespace Langulus::Flow
       return verb.GetSuccesses();
    }
 
+   namespace Inner
+   {
+
+      /// Check if elements of a type are certain to fail executing a verb,   
+      /// so that a dense context of them can be rejected with a single       
+      /// availability check, instead of attempting each element              
+      ///   @tparam DISPATCH - whether or not elements would be given to a    
+      ///      custom dispatcher, which might handle any verb                 
+      ///   @param type - the type of the elements                            
+      ///   @param verb - the verb to execute                                 
+      ///   @return true if no element can execute the verb                   
+      template<bool DISPATCH> LANGULUS(INLINED)
+      bool IsUnavailable(DMeta type, const Verb& verb) {
+         // Conversions use reflected converters, which aren't tracked  
+         if (not type or verb.template IsVerb<Verbs::Interpret>())
+            return false;
+         if (DISPATCH and (type->mDispatcherMutable or type->mDispatcherConstant))
+            return false;
+         return not IsAvailable(type, verb.GetVerb());
+      }
+
+   } // namespace Langulus::Flow::Inner
+
+   /// Try executing a verb on a whole flat context at once, using a          
+   /// registered whole-block ability. Only dense AND contexts are batched,   
+   /// and only if resolving elements can't yield a different type            
+   ///   @tparam RESOLVE - whether or not elements would be resolved          
+   ///   @param context - the flat context                                    
+   ///   @param verb - the verb to execute                                    
+   ///   @return the number of successful executions, zero if the context     
+   ///      wasn't batched, or the batch ability failed                       
+   template<bool RESOLVE>
+   Count DispatchBatch(CT::Deep auto& context, CT::VerbBased auto& verb) {
+      constexpr bool MUTABLE = CT::Mutable<Deref<decltype(context)>>;
+      if (context.IsOr() or context.IsSparse())
+         return 0;
+
+      const auto type = context.GetType();
+      if (not type or (RESOLVE and type->mResolver))
+         return 0;
+
+      const auto execute = [&](auto ability) -> Count {
+         verb.Undo();
+         verb.SetSource(context);
+         ability(context, verb);
+         if (not verb.IsDone()) {
+            verb.Undo();
+            return 0;
+         }
+
+         // Batch abilities output a flat block - retain the context    
+         // state, as the element-wise dispatch would                   
+         auto output = Many::FromState(context);
+         if (verb.GetOutput())
+            output.SmartPush(IndexBack, Langulus::Move(verb.GetOutput()));
+         return verb.template CompleteDispatch<false>(
+            context.GetCount(), Abandon(output));
+      };
+
+      if constexpr (MUTABLE) {
+         if (const auto ability = Inner::FindBatchAbilityMutable(type, verb.GetVerb()))
+            return execute(ability);
+      }
+
+      if (const auto ability = Inner::FindBatchAbilityConstant(type, verb.GetVerb()))
+         return execute(ability);
+      return 0;
+   }
+
    /// Invoke a verb on a flat context of as much elements as you want        
    /// If an element is not able to execute verb, attempt calling the default 
    /// This should be called only in memory blocks that are flat              
@@ -204,137 +278,272 @@ namespace Langulus::Flow
          }
       }
 
+      // Prefer whole-block abilities for flat homogeneous contexts     
+      if (const auto done = DispatchBatch<RESOLVE>(context, verb))
+         return done;
+
       Count successCount = 0;
       auto output = Many::FromState(context);
-
-      // Iterate elements in the current context                        
-      for (Count i = 0; i < context.GetCount(); ++i) {
-         //verb.SetSource(context.GetElement(i));
-         auto ith = context.GetElement(i);
-         if constexpr (RESOLVE)
-            ith = ith.GetResolved();
-         else
-            ith = ith.GetDense();
-
+      const auto count = context.GetCount();
+
+      // Elements of dense contexts are already as concrete as they     
+      // can get, unless their type is resolvable - skip resolving them 
+      const auto type = context.GetType();
+      const bool direct = context.IsDense()
+         and not (RESOLVE and type and type->mResolver);
+
+      // Short-circuited verbs need only the first success in OR        
+      // contexts, so there's no need to execute the rest of them       
+      const bool stopEarly = context.IsOr() and verb.IsShortCircuited();
+
+      // Elements, that can't execute the verb in any way, are all      
+      // rejected at once, unless there are default verbs to fall to    
+      const bool rejected = not DEFAULT and direct
+         and Inner::IsUnavailable<DISPATCH>(type, verb);
+
+      // Execute the verb in a single element                           
+      const auto execute = [&](auto& ith) {
+         // No need to Undo here - Execute always resets the verb       
          verb.SetSource(ith);
          Execute<DISPATCH, DEFAULT, false>(ith, verb);
-         
-         if (verb.IsDone()) {
-            if (verb.GetOutput()) {
-               // Cache output, conserving the context hierarchy        
-               output.SmartPush(IndexBack, Langulus::Move(verb.GetOutput()));
-            }
+         if (not verb.IsDone())
+            return Loop::Continue;
+
+         ++successCount;
+         if (verb.GetOutput())
+            Inner::MergeOutput(output, verb.GetOutput(), count);
+         return stopEarly ? Loop::Break : Loop::Continue;
+      };
+
+      if (not rejected and direct) {
+         // Dense elements are visited through a single element view,   
+         // whose pointer is advanced in place, instead of making a new 
+         // view for each of them                                       
+         if constexpr (CT::Mutable<Deref<decltype(context)>>)
+            context.ForEachElement([&](Block<>& ith) { return execute(ith); });
+         else
+            context.ForEachElement([&](const Block<>& ith) { return execute(ith); });
+      }
+      else if (not rejected) {
+         // Sparse or resolvable elements need a view of their own      
+         for (Count i = 0; i < count; ++i) {
+            auto ith = context.GetElement(i);
+            if constexpr (RESOLVE)
+               ith = ith.GetResolved();
+            else
+               ith = ith.GetDense();
 
-            ++successCount;
-            verb.Undo();
+            if (execute(ith) == Loop::Break)
+               break;
          }
       }
-      
+
       if (context.IsOr())
          return verb.template CompleteDispatch<true >(successCount, Abandon(output));
       else
          return verb.template CompleteDispatch<false>(successCount, Abandon(output));
    }
 
-   /// Invoke a verb on a container, that is either deep or flat, either      
-   /// AND, or OR. The verb will be executed for each flat element inside     
-   /// this block. If a failure occurs inside a scope, that scope will be     
-   /// considered failed, unless it's an OR scope - OR scopes stop execution  
-   /// right after the first success and fail only if all branches fail       
-   ///   @tparam RESOLVE - whether or not to perform runtime resolve of the   
-   ///                     contexts, getting the most concrete type           
-   ///   @tparam DISPATCH - whether or not to use custom dispatcher for       
-   ///                      contexts, if any                                  
-   ///   @tparam DEFAULT - whether or not to allow default/stateless verb     
-   ///                     execution, if all else fails                       
-   ///   @param context - the context in which scope will be dispatched to    
-   ///   @param verb - the verb to execute                                    
-   ///   @return the number of successful executions                          
-   template<bool RESOLVE, bool DISPATCH, bool DEFAULT>
-   Count DispatchDeep(CT::Deep auto& context, CT::VerbBased auto& verb) {
-      if (not context or verb.IsMonocast()) {
-         if (context.IsInvalid()) {
-            // Context is empty and doesn't have any relevant states,   
-            // and execution happens only if DEFAULT verbs are allowed, 
-            // as a stateless verb execution                            
-            if constexpr (DEFAULT)
-               return Verb::GenericExecuteStateless(verb);
-            else
-               return 0;
-         }
-         else {
-            // Context is empty, but has relevant states, so directly   
-            // forward it as context. Alternatively, the verb is not a  
-            // multicast verb, and we're operating on context as one    
-            verb.SetSource(context);
-            Execute<DISPATCH, DEFAULT, true>(context, verb);
-            return verb.GetSuccesses();
+   namespace Inner
+   {
+
+      /// Check if a deep context is worth dispatching in parallel            
+      /// Reference counts aren't atomic, so each subblock must be owned      
+      /// exclusively by the context, since workers touch them concurrently   
+      ///   @param context - the deep context                                 
+      ///   @param verb - the verb to dispatch                                
+      ///   @return true if subblocks can be dispatched in parallel           
+      LANGULUS(INLINED)
+      bool IsParallelizable(const Many& context, const A::Verb& verb) {
+         if (context.IsOr() or context.IsSparse()
+         or  context.GetCount() < ParallelDispatchThreshold
+         or  GetWorkerCount() < 2 or not IsThreadSafe(verb.GetVerb()))
+            return false;
+
+         for (Count i = 0; i < context.GetCount(); ++i) {
+            if (not IsThreadSafeFlow(context.template Get<Many>(i), true))
+               return false;
          }
+         return true;
       }
 
-      if (context.IsDeep()) {
-         // Nest if context is deep                                     
-         // There is no escape from this scope                          
+      /// Dispatch a verb to the subblocks of a deep AND context in parallel  
+      /// Each chunk of subblocks is dispatched with its own fork of the      
+      /// verb, and results are merged in subblock order afterwards, so the   
+      /// output is exactly the same as the one of a sequential dispatch      
+      ///   @param context - the deep context                                 
+      ///   @param verb - the verb to dispatch                                
+      ///   @return the number of successful executions                       
+      template<bool RESOLVE, bool DISPATCH, bool DEFAULT>
+      Count DispatchParallel(CT::Deep auto& context, CT::VerbBased auto& verb) {
+         const auto count = context.GetCount();
+         const auto chunk = ::std::max(count / (GetWorkerCount() * 4), Count {1});
+         const auto chunks = (count + chunk - 1) / chunk;
+
+         // Reference counting isn't atomic, so forks are made in this  
+         // thread, each with its own clone of the argument - workers   
+         // must never reference the same blocks                        
+         TMany<Deref<decltype(verb)>> forks;
+         forks.Reserve(chunks);
+         for (Count i = 0; i < chunks; ++i)
+            forks << verb.Fork(Clone(verb.GetArgument()));
+
+         // A slot for each subblock, so that workers never share. Each 
+         // subblock is visited exactly once, so all flags are written  
+         TMany<Many> outputs;
+         outputs.New(count);
+         TMany<uint8_t> done;
+         done.New(count);
+
+         ParallelFor(count, chunk, [&](Count from, Count to) {
+            auto& fork = forks[from / chunk];
+            for (Count i = from; i < to; ++i) {
+               Flow::DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
+                  context.template Get<Many>(i), fork);
+
+               done[i] = fork.IsDone();
+               if (done[i]) {
+                  outputs[i] = Langulus::Move(fork.GetOutput());
+                  fork.Undo();
+               }
+            }
+         });
+
+         // Merge in subblock order                                     
          Count successCount = 0;
          auto output = Many::FromState(context);
-         for (Count i = 0; i < context.GetCount(); ++i) {
-            DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
-               context.template Get<Many>(i), verb);
-
-            if (verb.IsDone()) {
-               if (verb.GetOutput()) {
-                  // Cache output, conserving the context hierarchy     
-                  output.SmartPush(IndexBack, Langulus::Move(verb.GetOutput()));
-               }
+         for (Count i = 0; i < count; ++i) {
+            if (not done[i])
+               continue;
 
-               ++successCount;
-               verb.Undo();
-            }
+            ++successCount;
+            if (outputs[i])
+               MergeOutput(output, outputs[i], count);
          }
 
-         if (context.IsOr())
-            return verb.template CompleteDispatch<true >(successCount, Abandon(output));
-         else
-            return verb.template CompleteDispatch<false>(successCount, Abandon(output));
+         return verb.template CompleteDispatch<false>(successCount, Abandon(output));
       }
-      else if (context.template Is<Trait>()) {
-         // Nest if context is trait                                    
-         // Traits are considered deep only when executing in them      
-         // There is no escape from this scope                          
-         Count successCount = 0;
-         auto output = Many::FromState(context);
-         for (Count i = 0; i < context.GetCount(); ++i) {
-            auto& t = context.template Get<Trait>(i);
-            if constexpr (CT::Constant<decltype(context)>) {
-               DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
-                  static_cast<const Many&>(t), verb);
+
+      /// Unprofiled implementation of Flow::DispatchDeep                     
+      /// Nested contexts are dispatched through Flow::DispatchDeep, so that  
+      /// each nesting level gets profiled, when profiling is enabled         
+      template<bool RESOLVE, bool DISPATCH, bool DEFAULT>
+      Count DispatchDeep(CT::Deep auto& context, CT::VerbBased auto& verb) {
+         if (not context or verb.IsMonocast()) {
+            if (context.IsInvalid()) {
+               // Context is empty and doesn't have any relevant states,
+               // and execution happens only if DEFAULT verbs are allowed,
+               // as a stateless verb execution                         
+               if constexpr (DEFAULT)
+                  return Verb::GenericExecuteStateless(verb);
+               else
+                  return 0;
             }
             else {
-               DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
-                  static_cast<Many&>(t), verb);
+               // Context is empty, but has relevant states, so directly
+               // forward it as context. Alternatively, the verb is not a
+               // multicast verb, and we're operating on context as one 
+               verb.SetSource(context);
+               Execute<DISPATCH, DEFAULT, true>(context, verb);
+               return verb.GetSuccesses();
             }
+         }
 
-            if (verb.IsDone()) {
-               if (verb.GetOutput()) {
-                  // Cache output, conserving the context hierarchy     
-                  output.SmartPush(IndexBack, Langulus::Move(verb.GetOutput()));
+         if (context.IsDeep()) {
+            // Nest if context is deep                                  
+            // There is no escape from this scope                       
+            if (IsParallelizable(context, verb))
+               return DispatchParallel<RESOLVE, DISPATCH, DEFAULT>(context, verb);
+
+            Count successCount = 0;
+            auto output = Many::FromState(context);
+            const bool stopEarly = context.IsOr() and verb.IsShortCircuited();
+            for (Count i = 0; i < context.GetCount(); ++i) {
+               Flow::DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
+                  context.template Get<Many>(i), verb);
+
+               if (verb.IsDone()) {
+                  if (verb.GetOutput())
+                     MergeOutput(output, verb.GetOutput(), context.GetCount());
+
+                  ++successCount;
+                  verb.Undo();
+                  if (stopEarly)
+                     break;
                }
+            }
 
-               ++successCount;
-               verb.Undo();
+            if (context.IsOr())
+               return verb.template CompleteDispatch<true >(successCount, Abandon(output));
+            else
+               return verb.template CompleteDispatch<false>(successCount, Abandon(output));
+         }
+         else if (context.template Is<Trait>()) {
+            // Nest if context is trait                                 
+            // Traits are considered deep only when executing in them   
+            // There is no escape from this scope                       
+            Count successCount = 0;
+            auto output = Many::FromState(context);
+            const bool stopEarly = context.IsOr() and verb.IsShortCircuited();
+            for (Count i = 0; i < context.GetCount(); ++i) {
+               auto& t = context.template Get<Trait>(i);
+               if constexpr (CT::Constant<decltype(context)>) {
+                  Flow::DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
+                     static_cast<const Many&>(t), verb);
+               }
+               else {
+                  Flow::DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(
+                     static_cast<Many&>(t), verb);
+               }
+
+               if (verb.IsDone()) {
+                  if (verb.GetOutput())
+                     MergeOutput(output, verb.GetOutput(), context.GetCount());
+
+                  ++successCount;
+                  verb.Undo();
+                  if (stopEarly)
+                     break;
+               }
             }
+
+            if (context.IsOr())
+               return verb.template CompleteDispatch<true >(successCount, Abandon(output));
+            else
+               return verb.template CompleteDispatch<false>(successCount, Abandon(output));
          }
 
-         if (context.IsOr())
-            return verb.template CompleteDispatch<true >(successCount, Abandon(output));
-         else
-            return verb.template CompleteDispatch<false>(successCount, Abandon(output));
+         // If reached, then block is flat                              
+         // Execute implemented verbs if available, or fallback to      
+         // default verbs, eventually                                   
+         return DispatchFlat<RESOLVE, DISPATCH, DEFAULT>(context, verb);
+      }
+
+   } // namespace Langulus::Flow::Inner
+
+   /// Invoke a verb on a container, that is either deep or flat, either      
+   /// AND, or OR. The verb will be executed for each flat element inside     
+   /// this block. If a failure occurs inside a scope, that scope will be     
+   /// considered failed, unless it's an OR scope - OR scopes stop execution  
+   /// right after the first success and fail only if all branches fail       
+   ///   @tparam RESOLVE - whether or not to perform runtime resolve of the   
+   ///                     contexts, getting the most concrete type           
+   ///   @tparam DISPATCH - whether or not to use custom dispatcher for       
+   ///                      contexts, if any                                  
+   ///   @tparam DEFAULT - whether or not to allow default/stateless verb     
+   ///                     execution, if all else fails                       
+   ///   @param context - the context in which scope will be dispatched to    
+   ///   @param verb - the verb to execute                                    
+   ///   @return the number of successful executions                          
+   template<bool RESOLVE, bool DISPATCH, bool DEFAULT>
+   Count DispatchDeep(CT::Deep auto& context, CT::VerbBased auto& verb) {
+      if (Profiler::IsEnabled()) {
+         Profiler::Scope profile {verb.GetVerb(), Profiler::Stage::Dispatch};
+         return profile.Complete(
+            Inner::DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(context, verb));
       }
 
-      // If reached, then block is flat                                 
-      // Execute implemented verbs if available, or fallback to         
-      // default verbs, eventually                                      
-      return DispatchFlat<RESOLVE, DISPATCH, DEFAULT>(context, verb);
+      return Inner::DispatchDeep<RESOLVE, DISPATCH, DEFAULT>(context, verb);
    }
 
 } // namespace Langulus::Flow
@@ -8,6 +8,7 @@
 #pragma once
 #include "GreaterOrEqual.hpp"
 #include "../TVerb.inl"
+#include "../inner/Comparison.hpp"
 
 #if 0
    #define VERBOSE_COMPARE(...) Logger::Verbose(__VA_ARGS__)
@@ -73,16 +74,7 @@ namespace Langulus::Verbs
    ///   @param verb - the verb instance to execute                           
    ///   @return true if execution was a success                              
    inline bool GreaterOrEqual::ExecuteDefault(const Many& context, Verb& verb) {
-      if (verb.IsMissing() or not context or context.IsMissing())
-         return false;
-
-      // Scan verb argument for elements interpretable as the context   
-      // Consider the hierarchy                                         
-      verb.ForEach([&](const Many&) {
-         TODO(); //compare
-      });
-
-      return verb.IsDone();
+      return Inner::CompareDefault<Inner::Comparison::GreaterOrEqual>(context, verb);
    }
 
 } // namespace Langulus::Verbs
@@ -0,0 +1,172 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Common.hpp"
+#include <Flow/Async.hpp>
+#include <Flow/Temporal.hpp>
+#include <Flow/Verbs/Select.hpp>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+
+/// A task that completes without ever suspending                             
+Task Complete(int value) {
+   co_return value;
+}
+
+/// A task that completes once the future is ready                            
+Task Await(std::future<int> future) {
+   co_return co_await std::move(future);
+}
+
+/// A task that fails once the future is ready                                
+Task Fail(std::future<int> future) {
+   const int value = co_await std::move(future);
+   throw std::runtime_error {"Failed task"};
+   co_return value;
+}
+
+/// A type that selects its value synchronously, for comparison               
+struct Immediate {
+   int mValue {};
+
+   void Select(Verb& verb) {
+      verb << mValue;
+   }
+};
+
+/// A type that selects its value in a task, that never suspends              
+struct Instant {
+   int mValue {};
+
+   void Select(Verb& verb) {
+      verb << Complete(mValue);
+   }
+};
+
+/// A type that selects a value, provided by the test after the selection     
+struct Awaiting {
+   static inline std::promise<int> Promise;
+   static inline int Selections = 0;
+
+   void Select(Verb& verb) {
+      ++Selections;
+      verb << Await(Promise.get_future());
+   }
+};
+
+/// A type whose selection fails, after the test provides a value             
+struct Failing {
+   void Select(Verb& verb) {
+      verb << Fail(Awaiting::Promise.get_future());
+   }
+};
+
+/// Make a verb, that selects the given source                                
+Verbs::Select SelectIn(const auto& source) {
+   Verbs::Select verb;
+   verb.SetSource(source);
+   return verb;
+}
+
+
+SCENARIO("Executing asynchronous verbs", "[async]") {
+   Verbs::Select::RegisterDispatch<Immediate, Instant, Awaiting, Failing>();
+   Awaiting::Promise = {};
+   Awaiting::Selections = 0;
+   Many context;
+
+   GIVEN("A verb, whose task completes synchronously") {
+      WHEN("Executed") {
+         Many output, expected;
+         REQUIRE(Execute(Many {SelectIn(Instant {5})}, context, output, false, true));
+         REQUIRE(Execute(Many {SelectIn(Immediate {5})}, context, expected, false, true));
+
+         THEN("The output is the result of the task") {
+            REQUIRE(output == expected);
+         }
+      }
+   }
+
+   GIVEN("A verb, whose task waits for another thread") {
+      WHEN("Executed without a driver") {
+         std::thread provider {[] {
+            std::this_thread::sleep_for(std::chrono::milliseconds {20});
+            Awaiting::Promise.set_value(7);
+         }};
+
+         Many output, expected;
+         const bool success = Execute(
+            Many {SelectIn(Awaiting {})}, context, output, false, true);
+         provider.join();
+         REQUIRE(Execute(Many {SelectIn(Immediate {7})}, context, expected, false, true));
+
+         THEN("Execution blocks until the task completes") {
+            REQUIRE(success);
+            REQUIRE(Awaiting::Selections == 1);
+            REQUIRE(output == expected);
+         }
+      }
+   }
+
+   GIVEN("A temporal flow with a verb, whose task waits for a value") {
+      Temporal flow;
+      flow.Push(SelectIn(Awaiting {}));
+
+      WHEN("Updated before the value is provided") {
+         Many sideffects;
+         REQUIRE(flow.Update({}, sideffects));
+         REQUIRE(flow.Update({}, sideffects));
+
+         THEN("The flow is parked, and the verb isn't executed again") {
+            REQUIRE(flow.IsSuspended());
+            REQUIRE_FALSE(sideffects);
+            REQUIRE(Awaiting::Selections == 1);
+         }
+      }
+
+      WHEN("Updated after the value is provided") {
+         Many sideffects;
+         REQUIRE(flow.Update({}, sideffects));
+         Awaiting::Promise.set_value(3);
+         REQUIRE(flow.Update({}, sideffects));
+
+         THEN("The parked verb is resumed on the later update") {
+            REQUIRE_FALSE(flow.IsSuspended());
+            REQUIRE(sideffects);
+            REQUIRE(Awaiting::Selections == 1);
+         }
+      }
+   }
+
+   GIVEN("A verb, whose task throws") {
+      WHEN("Executed without a driver") {
+         Awaiting::Promise.set_value(1);
+         Many output;
+         const bool success = Execute(
+            Many {SelectIn(Failing {})}, context, output, false, true);
+
+         THEN("Execution fails") {
+            REQUIRE_FALSE(success);
+         }
+      }
+
+      WHEN("The task is awaited directly") {
+         auto task = Fail(Awaiting::Promise.get_future());
+         Awaiting::Promise.set_value(1);
+         task.Wait();
+
+         THEN("The exception is rethrown when taking the result") {
+            REQUIRE(task.IsDone());
+            REQUIRE(task.IsFailed());
+            REQUIRE_THROWS_AS(task.TakeResult(), std::runtime_error);
+         }
+      }
+   }
+}
@@ -0,0 +1,933 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Common.hpp"
+#include <Flow/Verbs/Select.hpp>
+#include <Flow/Verbs/Lower.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/// A type that selects itself, counting how many times it was selected       
+struct Selectable {
+   int mValue {};
+   int mSelections {};
+
+   void Select(Verb& verb) {
+      ++mSelections;
+      verb << mValue;
+   }
+};
+
+/// Make a flat context of selectables                                        
+Many MakeSelectables(const std::initializer_list<int>& values) {
+   Many context;
+   for (auto value : values)
+      context << Selectable {value};
+   return context;
+}
+
+/// A type with a custom dispatcher, that handles all verbs by itself         
+struct Dispatching {
+   int mValue {};
+
+   void Do(Verb& verb) {
+      verb << mValue;
+   }
+};
+
+/// A type with no abilities, used only to query dispatch caches              
+struct Cached {
+   int mValue {};
+};
+
+/// A type, whose trampolines are registered only after dispatching to it     
+struct Late {
+   int mValue {};
+
+   void Select(Verb& verb) {
+      verb << mValue;
+   }
+};
+
+/// A type with a reflected ability, that is lent to cached types, as if it   
+/// was reflected in them after they were searched                            
+struct Reflected {
+   LANGULUS_VERBS(Verbs::Select);
+   int mValue {};
+
+   void Select(Verb& verb) {
+      verb << mValue;
+   }
+};
+
+/// Whole-block selection of cached types, used to change what dispatch       
+/// caches should find                                                        
+void SelectCached(TMany<Cached>& block, Verb& verb) {
+   for (Offset i = 0; i < block.GetCount(); ++i)
+      verb << block[i].mValue;
+}
+
+/// A type, that can be selected both element by element, and as a whole      
+/// block - counts how many times each way was used                           
+struct Batchable {
+   int mValue {};
+   static inline int Elements = 0;
+   static inline int Batches = 0;
+
+   void Select(Verb& verb) {
+      ++Elements;
+      verb << mValue;
+   }
+};
+
+/// Whole-block selection, that outputs all values at once                    
+void SelectBatch(TMany<Batchable>& block, Verb& verb) {
+   ++Batchable::Batches;
+   TMany<int> values;
+   for (Offset i = 0; i < block.GetCount(); ++i)
+      values << block[i].mValue;
+   verb << Abandon(values);
+}
+
+/// Whole-block selection, that always fails                                  
+void SelectNothing(TMany<Batchable>&, Verb&) {
+   ++Batchable::Batches;
+}
+
+/// Make a flat context of batchables                                         
+Many MakeBatchables(const std::initializer_list<int>& values) {
+   Many context;
+   for (auto value : values)
+      context << Batchable {value};
+   return context;
+}
+
+/// Dispatch a select verb in a context, without default verbs                
+Count DispatchSelect(Many& context, Verbs::Select& verb) {
+   return DispatchDeep<true, true, false>(context, verb);
+}
+
+/// A family of distinct types without abilities, used to overflow the        
+/// dispatch tables                                                           
+template<Offset N>
+struct Filler {
+   int mValue {};
+};
+
+/// More types than dispatch tables can hold                                  
+constexpr Offset FillerCount = 4096 + 64;
+
+/// Get the metas of fillers                                                  
+template<Offset... N>
+std::vector<DMeta> MakeFillers(std::index_sequence<N...>) {
+   return {MetaDataOf<Filler<N>>()...};
+}
+
+
+SCENARIO("Dispatching verbs in OR contexts", "[dispatch]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+
+   GIVEN("A flat OR context") {
+      auto shortContext = MakeSelectables({1, 2, 3});
+      auto longContext = MakeSelectables({1, 2, 3});
+      shortContext.MakeOr();
+      longContext.MakeOr();
+
+      WHEN("Dispatching short-circuited and long-circuited verbs") {
+         Verbs::Select shortVerb;
+         Verbs::Select longVerb;
+         shortVerb.ShortCircuit(true);
+         longVerb.ShortCircuit(false);
+
+         const auto shortSuccesses = DispatchSelect(shortContext, shortVerb);
+         const auto longSuccesses = DispatchSelect(longContext, longVerb);
+
+         THEN("Short-circuited dispatch stops at the first success") {
+            REQUIRE(shortSuccesses == 1);
+            REQUIRE(shortVerb.GetSuccesses() == 1);
+            REQUIRE(shortVerb.GetOutput().GetCount() == 1);
+            REQUIRE(shortContext.Get<Selectable>(0).mSelections == 1);
+            REQUIRE(shortContext.Get<Selectable>(1).mSelections == 0);
+            REQUIRE(shortContext.Get<Selectable>(2).mSelections == 0);
+         }
+
+         THEN("Long-circuited dispatch executes all branches") {
+            REQUIRE(longSuccesses == 3);
+            REQUIRE(longVerb.GetSuccesses() == 3);
+            REQUIRE(longVerb.GetOutput().GetCount() == 3);
+            REQUIRE(longVerb.GetOutput().IsOr());
+            for (Offset i = 0; i < 3; ++i)
+               REQUIRE(longContext.Get<Selectable>(i).mSelections == 1);
+         }
+
+         THEN("Both produce the same first output") {
+            REQUIRE(shortVerb.GetOutput().Get<int>(0) == 1);
+            REQUIRE(longVerb.GetOutput().Get<int>(0) == 1);
+         }
+      }
+   }
+
+   GIVEN("A deep OR context of AND contexts") {
+      Many shortContext;
+      shortContext << MakeSelectables({1, 2}) << MakeSelectables({3, 4});
+      shortContext.MakeOr();
+      Many longContext;
+      longContext << MakeSelectables({1, 2}) << MakeSelectables({3, 4});
+      longContext.MakeOr();
+
+      WHEN("Dispatching short-circuited and long-circuited verbs") {
+         Verbs::Select shortVerb;
+         Verbs::Select longVerb;
+         shortVerb.ShortCircuit(true);
+         longVerb.ShortCircuit(false);
+
+         const auto shortSuccesses = DispatchSelect(shortContext, shortVerb);
+         const auto longSuccesses = DispatchSelect(longContext, longVerb);
+
+         THEN("Short-circuited dispatch executes only the first branch") {
+            REQUIRE(shortSuccesses == 1);
+            auto& second = shortContext.Get<Many>(1);
+            REQUIRE(second.Get<Selectable>(0).mSelections == 0);
+            REQUIRE(second.Get<Selectable>(1).mSelections == 0);
+         }
+
+         THEN("Long-circuited dispatch executes all branches") {
+            REQUIRE(longSuccesses == 2);
+            auto& second = longContext.Get<Many>(1);
+            REQUIRE(second.Get<Selectable>(0).mSelections == 1);
+            REQUIRE(second.Get<Selectable>(1).mSelections == 1);
+         }
+      }
+   }
+
+   GIVEN("A flat AND context") {
+      auto shortContext = MakeSelectables({1, 2, 3});
+      auto longContext = MakeSelectables({1, 2, 3});
+
+      WHEN("Dispatching short-circuited and long-circuited verbs") {
+         Verbs::Select shortVerb;
+         Verbs::Select longVerb;
+         shortVerb.ShortCircuit(true);
+         longVerb.ShortCircuit(false);
+
+         const auto shortSuccesses = DispatchSelect(shortContext, shortVerb);
+         const auto longSuccesses = DispatchSelect(longContext, longVerb);
+
+         THEN("Short-circuiting doesn't affect AND contexts") {
+            REQUIRE(shortSuccesses == 3);
+            REQUIRE(longSuccesses == 3);
+            REQUIRE(shortVerb.GetOutput() == longVerb.GetOutput());
+         }
+      }
+   }
+}
+
+SCENARIO("Profiling dispatches", "[dispatch][profiler]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+   const auto meta = MetaVerbOf<Verbs::Select>();
+   Profiler::Enable(false);
+   Profiler::Reset();
+
+   GIVEN("A flat context") {
+      auto context = MakeSelectables({1, 2, 3});
+
+      WHEN("Dispatched while profiling is disabled") {
+         Verbs::Select verb;
+         DispatchSelect(context, verb);
+
+         THEN("Nothing is recorded") {
+            REQUIRE_FALSE(Profiler::IsEnabled());
+            REQUIRE(Profiler::GetStatistics(meta, Profiler::Stage::Dispatch).mCalls == 0);
+         }
+      }
+
+      WHEN("Dispatched while profiling is enabled, and then disabled again") {
+         Profiler::Enable();
+         for (int i = 0; i < 2; ++i) {
+            Verbs::Select verb;
+            DispatchSelect(context, verb);
+         }
+
+         Profiler::Enable(false);
+         Verbs::Select verb;
+         DispatchSelect(context, verb);
+         const auto stats = Profiler::GetStatistics(meta, Profiler::Stage::Dispatch);
+
+         THEN("Only the dispatches while enabled are recorded") {
+            REQUIRE(stats.mCalls == 2);
+            REQUIRE(stats.mSuccesses == 2);
+            REQUIRE(stats.mFailures == 0);
+            REQUIRE(Profiler::GetDepth() == 0);
+         }
+
+         THEN("Resetting clears the statistics") {
+            Profiler::Reset();
+            REQUIRE(Profiler::GetStatistics(meta, Profiler::Stage::Dispatch).mCalls == 0);
+         }
+      }
+   }
+
+   Profiler::Reset();
+}
+
+SCENARIO("Caching dispatch lookups", "[dispatch][cache]") {
+   const auto type = MetaDataOf<Cached>();
+   const auto verb = MetaVerbOf<Verbs::Select>();
+   Inner::UnregisterBatchAbility(type, verb);
+
+   GIVEN("A type without abilities") {
+      WHEN("Searched for abilities and converters repeatedly") {
+         const auto first = Inner::FindAbility<true>(type, verb, DMeta {});
+         const auto second = Inner::FindAbility<true>(type, verb, DMeta {});
+         const auto converter = Inner::FindConverter(type, MetaDataOf<Text>());
+
+         THEN("Misses are cached, and stay misses") {
+            REQUIRE_FALSE(first);
+            REQUIRE_FALSE(second);
+            REQUIRE_FALSE(Inner::FindAbility<false>(type, verb, DMeta {}));
+            REQUIRE_FALSE(converter);
+            REQUIRE_FALSE(Inner::FindConverter(type, MetaDataOf<Text>()));
+         }
+      }
+
+      WHEN("Invalidated explicitly") {
+         REQUIRE_FALSE(Inner::FindBatchAbility<true>(type, verb));
+         Inner::InvalidateDispatchCache();
+
+         THEN("Nothing changes, if nothing was registered meanwhile") {
+            REQUIRE_FALSE(Inner::FindBatchAbility<true>(type, verb));
+            REQUIRE_FALSE(Inner::FindAbility<true>(type, verb, DMeta {}));
+         }
+      }
+
+      WHEN("An ability is registered after a cached miss") {
+         REQUIRE_FALSE(Inner::FindBatchAbility<true>(type, verb));
+         REQUIRE_FALSE(Inner::IsAvailable(type, verb));
+         Inner::RegisterBatchAbility<Cached, Verbs::Select, SelectCached>();
+
+         THEN("The cached miss is invalidated in this thread") {
+            REQUIRE(Inner::FindBatchAbility<true>(type, verb));
+            REQUIRE(Inner::IsAvailable(type, verb));
+         }
+
+         THEN("Other threads find it, too") {
+            bool found {};
+            std::thread other {[&] {
+               found = Inner::FindBatchAbility<true>(type, verb) != nullptr
+                   and Inner::IsAvailable(type, verb);
+            }};
+            other.join();
+            REQUIRE(found);
+         }
+
+         THEN("Unregistering it invalidates the cached hit") {
+            REQUIRE(Inner::FindBatchAbility<true>(type, verb));
+            Inner::UnregisterBatchAbility(type, verb);
+            REQUIRE_FALSE(Inner::FindBatchAbility<true>(type, verb));
+            REQUIRE_FALSE(Inner::IsAvailable(type, verb));
+         }
+      }
+
+      WHEN("An ability is reflected after a cached miss") {
+         REQUIRE_FALSE(Inner::FindAbility<true>(type, verb, DMeta {}));
+         REQUIRE_FALSE(Inner::FindDispatcher(type, verb, DMeta {}).mAbilityMutable);
+         REQUIRE_FALSE(Inner::IsAvailable(type, verb));
+
+         using Abilities = std::remove_cvref_t<decltype(type->mAbilities)>;
+         auto& abilities = const_cast<Abilities&>(type->mAbilities);
+         const auto lent = MetaDataOf<Reflected>()->mAbilities.find(verb);
+         REQUIRE(lent != MetaDataOf<Reflected>()->mAbilities.end());
+         abilities.emplace(lent->first, lent->second);
+
+         const bool found = Inner::FindAbility<true>(type, verb, DMeta {}) != nullptr;
+         const bool resolved = Inner::FindDispatcher(type, verb, DMeta {}).mAbilityMutable != nullptr;
+         const bool available = Inner::IsAvailable(type, verb);
+         bool foundInOther {};
+         std::thread other {[&] {
+            foundInOther = Inner::FindAbility<true>(type, verb, DMeta {}) != nullptr;
+         }};
+         other.join();
+
+         abilities.erase(verb);
+         const bool forgotten = not Inner::FindAbility<true>(type, verb, DMeta {})
+            and not Inner::IsAvailable(type, verb);
+
+         THEN("It is found without invalidating the caches explicitly") {
+            REQUIRE(found);
+            REQUIRE(resolved);
+            REQUIRE(available);
+            REQUIRE(foundInOther);
+            REQUIRE(forgotten);
+         }
+      }
+   }
+
+   Inner::UnregisterBatchAbility(type, verb);
+}
+
+SCENARIO("Dispatching verbs to large deep contexts", "[dispatch][parallel]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+
+   GIVEN("Two deep contexts with many flat subcontexts") {
+      Many sequential, parallel;
+      for (int i = 0; i < 128; ++i) {
+         sequential << MakeSelectables({i, i + 1});
+         parallel << MakeSelectables({i, i + 1});
+      }
+
+      WHEN("Dispatched with an argument, sequentially and in parallel") {
+         Verbs::Select sequentialVerb {TMany<int> {1, 2, 3}};
+         DispatchSelect(sequential, sequentialVerb);
+
+         Inner::MarkThreadSafe<Verbs::Select>();
+         Verbs::Select parallelVerb {TMany<int> {1, 2, 3}};
+         DispatchSelect(parallel, parallelVerb);
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Outputs are the same, and the argument is left intact") {
+            REQUIRE(parallelVerb.GetSuccesses() == sequentialVerb.GetSuccesses());
+            REQUIRE(parallelVerb.GetOutput() == sequentialVerb.GetOutput());
+            REQUIRE(parallelVerb.GetArgument() == TMany<int> {1, 2, 3});
+         }
+      }
+   }
+
+   GIVEN("A deep context, whose subcontexts are all the same block") {
+      const auto shared = MakeSelectables({1, 2});
+      Many context;
+      for (int i = 0; i < 128; ++i)
+         context << shared;
+
+      WHEN("Dispatched with a thread-safe verb") {
+         Inner::MarkThreadSafe<Verbs::Select>();
+         Verbs::Select verb;
+         const auto successes = DispatchSelect(context, verb);
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Subcontexts are dispatched sequentially") {
+            REQUIRE(successes == 128);
+            REQUIRE(shared.Get<Selectable>(0).mSelections == 128);
+            REQUIRE(shared.Get<Selectable>(1).mSelections == 128);
+         }
+      }
+   }
+}
+
+SCENARIO("Dispatching verbs to flat contexts", "[dispatch]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+
+   GIVEN("A dense flat context") {
+      auto resolved = MakeSelectables({1, 2, 3});
+      auto unresolved = MakeSelectables({1, 2, 3});
+
+      WHEN("Dispatched with and without resolving elements") {
+         Verbs::Select resolvedVerb;
+         Verbs::Select unresolvedVerb;
+         const auto resolvedSuccesses = DispatchSelect(resolved, resolvedVerb);
+         const auto unresolvedSuccesses =
+            DispatchDeep<false, true, false>(unresolved, unresolvedVerb);
+
+         THEN("Elements are dispatched directly, with the same results") {
+            REQUIRE(resolvedSuccesses == 3);
+            REQUIRE(unresolvedSuccesses == 3);
+            REQUIRE(resolvedVerb.GetOutput() == unresolvedVerb.GetOutput());
+            for (Offset i = 0; i < 3; ++i) {
+               REQUIRE(resolved.Get<Selectable>(i).mSelections == 1);
+               REQUIRE(unresolved.Get<Selectable>(i).mSelections == 1);
+            }
+         }
+      }
+   }
+
+   GIVEN("A sparse flat context") {
+      Selectable a {1}, b {2}, c {3};
+      Many context;
+      context << &a << &b << &c;
+
+      WHEN("Dispatched") {
+         Verbs::Select verb;
+         const auto successes = DispatchSelect(context, verb);
+         auto dense = MakeSelectables({1, 2, 3});
+         Verbs::Select denseVerb;
+         DispatchSelect(dense, denseVerb);
+
+         THEN("Elements are dereferenced, and the pointees are selected") {
+            REQUIRE(context.IsSparse());
+            REQUIRE(successes == 3);
+            REQUIRE(a.mSelections == 1);
+            REQUIRE(b.mSelections == 1);
+            REQUIRE(c.mSelections == 1);
+            REQUIRE(verb.GetOutput() == denseVerb.GetOutput());
+         }
+      }
+   }
+}
+
+SCENARIO("Dispatching verbs to whole blocks", "[dispatch][batch]") {
+   Verbs::Select::RegisterDispatch<Batchable>();
+   const auto type = MetaDataOf<Batchable>();
+   const auto meta = MetaVerbOf<Verbs::Select>();
+
+   GIVEN("A flat AND context, with a whole-block ability") {
+      Inner::RegisterBatchAbility<Batchable, Verbs::Select, SelectBatch>();
+      Batchable::Elements = Batchable::Batches = 0;
+      auto context = MakeBatchables({1, 2, 3});
+
+      WHEN("Dispatched") {
+         Verbs::Select verb;
+         const auto successes = DispatchSelect(context, verb);
+
+         THEN("The whole block is executed at once") {
+            REQUIRE(successes == 3);
+            REQUIRE(Batchable::Batches == 1);
+            REQUIRE(Batchable::Elements == 0);
+            REQUIRE(verb.GetOutput() == TMany<int> {1, 2, 3});
+         }
+      }
+
+      WHEN("Dispatched as an OR context") {
+         context.MakeOr();
+         Verbs::Select verb;
+         const auto successes = DispatchSelect(context, verb);
+
+         THEN("OR contexts are never batched") {
+            REQUIRE(successes > 0);
+            REQUIRE(Batchable::Batches == 0);
+            REQUIRE(Batchable::Elements > 0);
+         }
+      }
+   }
+
+   GIVEN("A flat AND context, with a failing whole-block ability") {
+      Inner::RegisterBatchAbility<Batchable, Verbs::Select, SelectNothing>();
+      Batchable::Elements = Batchable::Batches = 0;
+      auto context = MakeBatchables({1, 2, 3});
+
+      WHEN("Dispatched") {
+         Verbs::Select verb;
+         const auto successes = DispatchSelect(context, verb);
+
+         THEN("Dispatch falls back to executing element by element") {
+            REQUIRE(successes == 3);
+            REQUIRE(Batchable::Batches == 1);
+            REQUIRE(Batchable::Elements == 3);
+            REQUIRE(verb.GetOutput().GetCount() == 3);
+         }
+      }
+   }
+
+   GIVEN("A flat AND context, without a whole-block ability") {
+      Inner::UnregisterBatchAbility(type, meta);
+      Batchable::Elements = Batchable::Batches = 0;
+      auto context = MakeBatchables({1, 2, 3});
+
+      WHEN("Dispatched") {
+         Verbs::Select verb;
+         const auto successes = DispatchSelect(context, verb);
+
+         THEN("Elements are executed one by one") {
+            REQUIRE(successes == 3);
+            REQUIRE(Batchable::Batches == 0);
+            REQUIRE(Batchable::Elements == 3);
+         }
+      }
+   }
+
+   Inner::UnregisterBatchAbility(type, meta);
+}
+
+SCENARIO("Resolving dispatchers", "[dispatch][cache]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+   const auto verb = MetaVerbOf<Verbs::Select>();
+
+   GIVEN("A type with registered trampolines, but no reflected abilities") {
+      const auto type = MetaDataOf<Selectable>();
+
+      WHEN("Resolved with different argument types") {
+         const auto none = Inner::FindDispatcher(type, verb, DMeta {});
+         const auto numbers = Inner::FindDispatcher(type, verb, MetaDataOf<int>());
+
+         THEN("Both use the same mutable trampoline") {
+            REQUIRE(none.mTrampolineMutable);
+            REQUIRE_FALSE(none.mAbilityMutable);
+            REQUIRE_FALSE(none.mAbilityConstant);
+            REQUIRE(numbers.mTrampolineMutable == none.mTrampolineMutable);
+         }
+      }
+
+      WHEN("Dispatched with different arguments") {
+         auto context = MakeSelectables({1, 2});
+         Verbs::Select withNumber {5};
+         Verbs::Select withText {Text {"five"}};
+         const auto first = DispatchSelect(context, withNumber);
+         const auto second = DispatchSelect(context, withText);
+
+         THEN("The trampoline executes the verb each time") {
+            REQUIRE(first == 2);
+            REQUIRE(second == 2);
+            REQUIRE(withNumber.GetOutput() == withText.GetOutput());
+            REQUIRE(context.Get<Selectable>(0).mSelections == 2);
+         }
+      }
+   }
+
+   GIVEN("A type without any abilities") {
+      WHEN("Resolved") {
+         const auto dispatcher = Inner::FindDispatcher(MetaDataOf<Cached>(), verb, DMeta {});
+
+         THEN("Nothing is found") {
+            REQUIRE_FALSE(dispatcher.mAbilityMutable);
+            REQUIRE_FALSE(dispatcher.mAbilityConstant);
+            REQUIRE_FALSE(dispatcher.mTrampolineMutable);
+            REQUIRE_FALSE(dispatcher.mTrampolineConstant);
+         }
+      }
+   }
+
+   GIVEN("A type, resolved before its trampolines are registered") {
+      const auto type = MetaDataOf<Late>();
+      const auto before = Inner::FindDispatcher(type, verb, DMeta {});
+      Verbs::Select::RegisterDispatch<Late>();
+      const auto after = Inner::FindDispatcher(type, verb, DMeta {});
+
+      THEN("Registering invalidates the cached resolution") {
+         REQUIRE_FALSE(before.mTrampolineMutable);
+         REQUIRE(after.mTrampolineMutable);
+      }
+   }
+}
+
+SCENARIO("Checking availability of verbs", "[dispatch][cache]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+   const auto verb = MetaVerbOf<Verbs::Select>();
+
+   GIVEN("A type, whose abilities change while other threads check them") {
+      const auto type = MetaDataOf<Cached>();
+      Inner::UnregisterBatchAbility(type, verb);
+
+      WHEN("A whole-block ability is registered and unregistered") {
+         std::atomic<bool> done {};
+         std::vector<std::thread> readers;
+         std::vector<char> results(4, 1);
+         for (Offset i = 0; i < results.size(); ++i) {
+            readers.emplace_back([&, i] {
+               while (not done.load())
+                  (void) Inner::IsAvailable(type, verb);
+               results[i] = Inner::IsAvailable(type, verb);
+            });
+         }
+
+         for (int i = 0; i < 100; ++i) {
+            Inner::RegisterBatchAbility<Cached, Verbs::Select, SelectCached>();
+            Inner::UnregisterBatchAbility(type, verb);
+         }
+         done = true;
+         for (auto& reader : readers)
+            reader.join();
+
+         THEN("No thread keeps an availability from before the change") {
+            for (auto result : results)
+               REQUIRE_FALSE(result);
+            REQUIRE_FALSE(Inner::IsAvailable(type, verb));
+         }
+      }
+   }
+
+   GIVEN("A flat context of a type, that can't execute the verb") {
+      Many context;
+      context << Cached {1} << Cached {2};
+
+      WHEN("The verb is dispatched") {
+         Verbs::Select select;
+         const auto successes = DispatchSelect(context, select);
+
+         THEN("All elements are rejected") {
+            REQUIRE(successes == 0);
+            REQUIRE_FALSE(select.IsDone());
+            REQUIRE_FALSE(select.GetOutput());
+            REQUIRE_FALSE(select.GenericAvailableFor<Cached>());
+            REQUIRE(select.GenericAvailableFor<Selectable>());
+         }
+      }
+   }
+
+   GIVEN("More types than the dispatch tables can hold") {
+      const auto fillers = MakeFillers(std::make_index_sequence<FillerCount> {});
+      for (auto type : fillers)
+         REQUIRE_FALSE(Inner::IsAvailable(type, verb));
+
+      WHEN("Checked again") {
+         Count available = 0;
+         for (auto type : fillers)
+            available += Inner::IsAvailable(type, verb);
+
+         THEN("Queries don't take up ids, and are answered correctly") {
+            REQUIRE(available == 0);
+            for (auto type : fillers)
+               REQUIRE(Inner::GetTypeId(type) == 0);
+            REQUIRE(Inner::IsAvailable(MetaDataOf<Selectable>(), verb));
+         }
+      }
+
+      WHEN("An ability is registered for one of the queried types") {
+         const auto type = fillers.back();
+         Inner::RegisterBatchAbility(type, verb,
+            static_cast<Inner::BatchAbilityMutable>([](Many&, Verb&) {}));
+         const bool registered = Inner::IsAvailable(type, verb);
+         Inner::UnregisterBatchAbility(type, verb);
+
+         THEN("Availability follows the registration, in all threads") {
+            REQUIRE(registered);
+            REQUIRE_FALSE(Inner::IsAvailable(type, verb));
+
+            bool found = true;
+            std::thread other {[&] {
+               found = Inner::IsAvailable(type, verb);
+            }};
+            other.join();
+            REQUIRE_FALSE(found);
+         }
+      }
+   }
+}
+
+SCENARIO("Output pooling in deep dispatches", "[dispatch][bench]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+
+   GIVEN("A deep context of flat contexts") {
+      Many context;
+      for (int i = 0; i < 64; ++i)
+         context << MakeSelectables({1, 2, 3, 4, 5, 6, 7, 8});
+
+      WHEN("Dispatched repeatedly") {
+         Inner::ClearOutputPool();
+         const auto allocations = Profiler::GetAllocations();
+         constexpr int Repeats = 16;
+         for (int i = 0; i < Repeats; ++i) {
+            Verbs::Select verb;
+            DispatchSelect(context, verb);
+         }
+
+         const auto& stats = Inner::GetOutputPoolStatistics();
+         Logger::Info("Deep dispatch: ",
+            (Profiler::GetAllocations() - allocations) / Repeats,
+            " net allocations per dispatch, ", stats.mReused, " of ",
+            stats.mAcquired, " outputs reused from the pool");
+
+         THEN("Output containers are reused across levels and dispatches") {
+            REQUIRE(stats.mAcquired > 0);
+            REQUIRE(stats.mReused > 0);
+            REQUIRE(stats.mRecycled > 0);
+         }
+      }
+
+      BENCHMARK_ADVANCED("Deep dispatch with pooled outputs") (timer meter) {
+         meter.measure([&] {
+            Verbs::Select verb;
+            return DispatchSelect(context, verb);
+         });
+      };
+   }
+
+   GIVEN("A deep OR context of flat AND contexts, and a warm pool") {
+      Many context;
+      context << MakeSelectables({1, 2}) << MakeSelectables({3, 4});
+      context.MakeOr();
+
+      Many warmup;
+      for (int i = 0; i < 4; ++i)
+         warmup << MakeSelectables({1, 2, 3});
+      Verbs::Select warm;
+      DispatchSelect(warmup, warm);
+
+      WHEN("Dispatched with a long-circuited verb") {
+         Verbs::Select verb;
+         verb.ShortCircuit(false);
+         REQUIRE(DispatchSelect(context, verb) == 2);
+         const auto& output = verb.GetOutput();
+
+         THEN("Each branch remains a separate AND alternative") {
+            REQUIRE(output.IsOr());
+            REQUIRE(output.IsDeep());
+            REQUIRE(output.GetCount() == 2);
+            REQUIRE_FALSE(output.Get<Many>(0).IsOr());
+            REQUIRE(output.Get<Many>(0).GetCount() == 2);
+            REQUIRE(output.Get<Many>(0).Get<int>(1) == 2);
+            REQUIRE_FALSE(output.Get<Many>(1).IsOr());
+            REQUIRE(output.Get<Many>(1).GetCount() == 2);
+            REQUIRE(output.Get<Many>(1).Get<int>(1) == 4);
+         }
+      }
+   }
+
+   GIVEN("A deep AND context of flat OR contexts, and a warm pool") {
+      auto first = MakeSelectables({1, 2});
+      auto second = MakeSelectables({3, 4});
+      first.MakeOr();
+      second.MakeOr();
+      Many context;
+      context << first << second;
+
+      Many warmup;
+      for (int i = 0; i < 4; ++i)
+         warmup << MakeSelectables({1, 2, 3});
+      Verbs::Select warm;
+      DispatchSelect(warmup, warm);
+
+      WHEN("Dispatched with a long-circuited verb") {
+         Verbs::Select verb;
+         verb.ShortCircuit(false);
+         REQUIRE(DispatchSelect(context, verb) == 2);
+         const auto& output = verb.GetOutput();
+
+         THEN("The OR state of each branch is preserved") {
+            REQUIRE_FALSE(output.IsOr());
+            REQUIRE(output.IsDeep());
+            REQUIRE(output.GetCount() == 2);
+            REQUIRE(output.Get<Many>(0).IsOr());
+            REQUIRE(output.Get<Many>(0).GetCount() == 2);
+            REQUIRE(output.Get<Many>(1).IsOr());
+            REQUIRE(output.Get<Many>(1).GetCount() == 2);
+         }
+      }
+   }
+}
+
+/// Dispatch a verb in a context repeatedly, and log the time spent per       
+/// element, as well as the net allocations per dispatch                      
+template<class V>
+void ReportDispatch(const char* name, Many& context, Count elements, const V& verb) {
+   constexpr int Repeats = 256;
+   const auto allocations = Profiler::GetAllocations();
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < Repeats; ++i) {
+      V local = verb;
+      DispatchDeep(context, local);
+   }
+
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+   const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+   Logger::Info(name, ": ", fmt::format("{:.2f}", ns / (Repeats * elements)),
+      " ns/element, ", (Profiler::GetAllocations() - allocations) / Repeats,
+      " net allocations per dispatch");
+}
+
+SCENARIO("Dispatch benchmarks", "[dispatch][bench]") {
+   Verbs::Select::RegisterDispatch<Selectable>();
+   constexpr int Elements = 1024;
+
+   GIVEN("A flat homogeneous POD block") {
+      TMany<int> numbers;
+      for (int i = 0; i < Elements; ++i)
+         numbers << i;
+      Many context = numbers;
+      const Verbs::Lower verb {Elements / 2};
+      ReportDispatch("Flat POD", context, Elements, verb);
+
+      BENCHMARK_ADVANCED("Flat POD") (timer meter) {
+         meter.measure([&] {
+            auto local = verb;
+            return DispatchDeep(context, local);
+         });
+      };
+   }
+
+   GIVEN("A sparse block, whose elements have to be resolved") {
+      std::vector<Selectable> storage(Elements);
+      Many context;
+      for (auto& element : storage)
+         context << &element;
+      const Verbs::Select verb;
+      ReportDispatch("Sparse", context, Elements, verb);
+
+      BENCHMARK_ADVANCED("Sparse") (timer meter) {
+         meter.measure([&] {
+            auto local = verb;
+            return DispatchDeep(context, local);
+         });
+      };
+   }
+
+   GIVEN("A deep nest of flat blocks") {
+      Many context;
+      for (int i = 0; i < Elements / 16; ++i) {
+         Many inner;
+         inner << MakeSelectables({1, 2, 3, 4, 5, 6, 7, 8})
+               << MakeSelectables({1, 2, 3, 4, 5, 6, 7, 8});
+         context << Abandon(inner);
+      }
+      const Verbs::Select verb;
+      ReportDispatch("Deep", context, Elements, verb);
+
+      BENCHMARK_ADVANCED("Deep") (timer meter) {
+         meter.measure([&] {
+            auto local = verb;
+            return DispatchDeep(context, local);
+         });
+      };
+   }
+
+   GIVEN("Trait-wrapped blocks") {
+      Many context;
+      for (int i = 0; i < Elements / 8; ++i)
+         context << Traits::Name(MakeSelectables({1, 2, 3, 4, 5, 6, 7, 8}));
+      const Verbs::Select verb;
+      ReportDispatch("Traits", context, Elements, verb);
+
+      BENCHMARK_ADVANCED("Traits") (timer meter) {
+         meter.measure([&] {
+            auto local = verb;
+            return DispatchDeep(context, local);
+         });
+      };
+   }
+
+   GIVEN("An OR block") {
+      Many context;
+      for (int i = 0; i < Elements; ++i)
+         context << Selectable {i};
+      context.MakeOr();
+      auto shortVerb = Verbs::Select().ShortCircuit(true);
+      auto longVerb = Verbs::Select().ShortCircuit(false);
+      ReportDispatch("OR, short-circuited", context, Elements, shortVerb);
+      ReportDispatch("OR, long-circuited", context, Elements, longVerb);
+
+      BENCHMARK_ADVANCED("OR, short-circuited") (timer meter) {
+         meter.measure([&] {
+            auto local = shortVerb;
+            return DispatchDeep(context, local);
+         });
+      };
+
+      BENCHMARK_ADVANCED("OR, long-circuited") (timer meter) {
+         meter.measure([&] {
+            auto local = longVerb;
+            return DispatchDeep(context, local);
+         });
+      };
+   }
+
+   GIVEN("A block of a type with a custom dispatcher") {
+      Many context;
+      for (int i = 0; i < Elements; ++i)
+         context << Dispatching {i};
+      const Verbs::Select verb;
+      ReportDispatch("Custom dispatcher", context, Elements, verb);
+
+      BENCHMARK_ADVANCED("Custom dispatcher") (timer meter) {
+         meter.measure([&] {
+            auto local = verb;
+            return DispatchDeep(context, local);
+         });
+      };
+   }
+}
@@ -0,0 +1,105 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Common.hpp"
+#include <Flow/Verbs/Select.hpp>
+#include <vector>
+
+
+/// A type that selects itself, used as a context for batches                 
+struct Batched {
+   int mValue {};
+
+   void Select(Verb& verb) {
+      verb << mValue;
+   }
+};
+
+/// Make a number of contexts, each with a single batched element             
+std::vector<Many> MakeBatch(int count) {
+   std::vector<Many> contexts;
+   for (int i = 0; i < count; ++i)
+      contexts.emplace_back(Many {Batched {i}});
+   return contexts;
+}
+
+/// Execute a flow in each context one by one, the way ExecuteBatch should    
+Many ExecuteSequentially(const Many& flow, std::vector<Many>& contexts) {
+   TMany<Many> results;
+   results.New(contexts.size());
+   for (Offset i = 0; i < contexts.size(); ++i) {
+      Many local = Many {Clone(flow)};
+      REQUIRE(Execute(local, contexts[i], results[i], false, true));
+   }
+
+   Many outputs;
+   outputs.SmartPush(IndexBack, Abandon(results));
+   return outputs;
+}
+
+
+SCENARIO("Executing a flow in a batch of contexts", "[executor]") {
+   Verbs::Select::RegisterDispatch<Batched>();
+
+   GIVEN("A flow and many contexts") {
+      const Many flow = Verbs::Select {};
+      auto reference = MakeBatch(64);
+      const auto expected = ExecuteSequentially(flow, reference);
+
+      WHEN("Executed as a sequential batch") {
+         auto contexts = MakeBatch(64);
+         Many outputs;
+         const bool success = ExecuteBatch(flow, contexts, outputs, false, true);
+
+         THEN("Outputs are the same as executing in each context") {
+            REQUIRE(success);
+            REQUIRE(outputs == expected);
+         }
+      }
+
+      WHEN("Executed as a parallel batch, with a thread-unsafe verb") {
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+         auto contexts = MakeBatch(64);
+         Many outputs;
+         const bool success = ExecuteBatch(flow, contexts, outputs, true, true);
+
+         THEN("Execution falls back to sequential, with the same outputs") {
+            REQUIRE(success);
+            REQUIRE(outputs == expected);
+         }
+      }
+
+      WHEN("Executed as a parallel batch, with a thread-safe verb") {
+         Inner::MarkThreadSafe<Verbs::Select>();
+         auto contexts = MakeBatch(64);
+         Many outputs;
+         const bool success = ExecuteBatch(flow, contexts, outputs, true, true);
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Outputs are the same, and in the order of the contexts") {
+            REQUIRE(success);
+            REQUIRE(outputs == expected);
+         }
+      }
+
+      WHEN("Executed as a parallel batch, in contexts that are shared") {
+         Inner::MarkThreadSafe<Verbs::Select>();
+         const Many shared = Batched {7};
+         std::vector<Many> contexts(64, shared);
+         std::vector<Many> references(64, shared);
+         const auto sharedExpected = ExecuteSequentially(flow, references);
+         Many outputs;
+         const bool success = ExecuteBatch(flow, contexts, outputs, true, true);
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Execution falls back to sequential, with the same outputs") {
+            REQUIRE(success);
+            REQUIRE(outputs == sharedExpected);
+         }
+      }
+   }
+}
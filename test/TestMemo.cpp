@@ -0,0 +1,136 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Common.hpp"
+#include <Flow/Memo.hpp>
+#include <Flow/Verbs/Lower.hpp>
+#include <Flow/Verbs/Select.hpp>
+#include <Flow/Verbs/Catenate.hpp>
+
+
+/// A type that counts all of its selections, across all copies               
+struct Memoized {
+   int mValue {};
+   static inline int Selections = 0;
+
+   void Select(Verb& verb) {
+      ++Selections;
+      verb << mValue;
+   }
+};
+
+/// Make a flow, that compares a block of integers to a single integer        
+Many MakeComparison(int rhs) {
+   Verbs::Lower verb {rhs};
+   verb.SetSource(TMany<int> {1, 5, 3, 4});
+   return verb;
+}
+
+
+SCENARIO("Memoizing pure verbs", "[memo]") {
+   Verbs::Select::RegisterDispatch<Memoized>();
+
+   GIVEN("A memoization table") {
+      Memo memo;
+      const Memo::Scope scope {&memo};
+      Many context;
+
+      WHEN("The same pure verb is executed twice") {
+         Many first, second;
+         REQUIRE(Execute(MakeComparison(4), context, first, false, true));
+         REQUIRE(Execute(MakeComparison(4), context, second, false, true));
+
+         THEN("The second execution is recalled") {
+            REQUIRE(memo.GetCount() == 1);
+            REQUIRE(memo.GetStatistics().mHits == 1);
+            REQUIRE(memo.GetStatistics().mMisses == 1);
+            REQUIRE(first == second);
+         }
+      }
+
+      WHEN("The same pure verb is executed with a different argument") {
+         Many first, second;
+         REQUIRE(Execute(MakeComparison(4), context, first, false, true));
+         REQUIRE(Execute(MakeComparison(2), context, second, false, true));
+
+         THEN("Both executions miss, and are remembered separately") {
+            REQUIRE(memo.GetCount() == 2);
+            REQUIRE(memo.GetStatistics().mHits == 0);
+            REQUIRE(memo.GetStatistics().mMisses == 2);
+            REQUIRE(first != second);
+         }
+      }
+
+      WHEN("The same pure verb is executed with a different source") {
+         Verbs::Lower verb {4};
+         verb.SetSource(TMany<int> {6, 1});
+         Many first, second;
+         REQUIRE(Execute(MakeComparison(4), context, first, false, true));
+         REQUIRE(Execute(Many {verb}, context, second, false, true));
+
+         THEN("Both executions miss") {
+            REQUIRE(memo.GetCount() == 2);
+            REQUIRE(memo.GetStatistics().mHits == 0);
+            REQUIRE(memo.GetStatistics().mMisses == 2);
+         }
+      }
+
+      WHEN("An impure verb is executed twice") {
+         Memoized::Selections = 0;
+         Verbs::Select verb;
+         verb.SetSource(Memoized {1});
+         Many first, second;
+         REQUIRE(Execute(Many {verb}, context, first, false, true));
+         REQUIRE(Execute(Many {verb}, context, second, false, true));
+
+         THEN("The table is bypassed, and the verb is executed each time") {
+            REQUIRE_FALSE(Memo::IsPure(MetaVerbOf<Verbs::Select>()));
+            REQUIRE(Memoized::Selections == 2);
+            REQUIRE(memo.GetCount() == 0);
+            REQUIRE(memo.GetStatistics().mHits == 0);
+            REQUIRE(memo.GetStatistics().mMisses == 0);
+         }
+      }
+
+      WHEN("A pure verb is executed twice, with a sparse source") {
+         Memo::MarkPure<Verbs::Select>();
+         Memoized::Selections = 0;
+         Memoized memoized {1};
+         Verbs::Select verb;
+         verb.SetSource(&memoized);
+         Many first, second;
+         REQUIRE(Execute(Many {verb}, context, first, false, true));
+         memoized.mValue = 2;
+         REQUIRE(Execute(Many {verb}, context, second, false, true));
+         Memo::MarkPure<Verbs::Select>(false);
+
+         THEN("The table is bypassed, since the pointee might change") {
+            REQUIRE(Memoized::Selections == 2);
+            REQUIRE(memo.GetCount() == 0);
+            REQUIRE(first != second);
+         }
+      }
+   }
+
+   GIVEN("The built-in pure verbs") {
+      THEN("Catenate isn't pure, because it modifies its context") {
+         REQUIRE(Memo::IsPure(MetaVerbOf<Verbs::Lower>()));
+         REQUIRE_FALSE(Memo::IsPure(MetaVerbOf<Verbs::Catenate>()));
+      }
+
+      WHEN("A verb is marked pure, and then impure again") {
+         Memo::MarkPure<Verbs::Select>();
+         const bool marked = Memo::IsPure(MetaVerbOf<Verbs::Select>());
+         Memo::MarkPure<Verbs::Select>(false);
+
+         THEN("Cached purity follows the marks") {
+            REQUIRE(marked);
+            REQUIRE_FALSE(Memo::IsPure(MetaVerbOf<Verbs::Select>()));
+         }
+      }
+   }
+}
@@ -0,0 +1,819 @@
+///                                                                           
+/// Langulus::Flow                                                            
+/// Copyright (c) 2017 Dimo Markov <team@langulus.com>                        
+/// Part of the Langulus framework, see https://langulus.com                  
+///                                                                           
+/// SPDX-License-Identifier: GPL-3.0-or-later                                 
+///                                                                           
+#include "Common.hpp"
+#include <Flow/Temporal.hpp>
+#include <Flow/Verbs/Select.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+/// A type that counts all selections of all of its copies, because flows     
+/// execute verbs in their own copies of the source, along with the number of 
+/// periods these selections accounted for                                    
+struct Ticker {
+   int mValue {};
+   static inline int Selections = 0;
+   static inline Count Ticks = 0;
+
+   void Select(Verb& verb) {
+      ++Selections;
+      Ticks += Temporal::GetTicks();
+      verb << mValue;
+   }
+};
+
+/// A type that counts all of its selections, even from different threads     
+struct Concurrent {
+   int mValue {};
+   static inline std::atomic<int> Selections = 0;
+
+   void Select(Verb& verb) {
+      ++Selections;
+      verb << mValue;
+   }
+};
+
+/// Make a flow, that selects concurrent values at a number of different      
+/// rates and times, and optionally updates them in parallel                  
+void PushConcurrent(Temporal& flow, bool parallel) {
+   flow.SetParallel(parallel);
+   for (int i = 1; i <= 4; ++i) {
+      Verbs::Select periodic;
+      periodic.SetSource(Concurrent {i});
+      periodic.SetRate(i);
+      flow.Push(periodic);
+
+      Verbs::Select timed;
+      timed.SetSource(Concurrent {i * 10});
+      timed.SetTime(i * 0.1);
+      flow.Push(timed);
+   }
+}
+
+/// Update a concurrent flow, so that many time points and periodic flows     
+/// are due at once                                                           
+///   @param flow - the flow to update                                        
+///   @param sideffects - [out] the side effects of all updates               
+void UpdateConcurrent(Temporal& flow, Many& sideffects) {
+   REQUIRE(flow.Update(1s, sideffects));
+   for (int i = 0; i < 16; ++i)
+      REQUIRE(flow.Update(16ms, sideffects));
+}
+
+/// Make a verb, that selects a ticker with the given value                   
+Verbs::Select Tick(int value) {
+   Verbs::Select verb;
+   verb.SetSource(Ticker {value});
+   return verb;
+}
+
+/// Make a verb, that selects a ticker periodically                           
+///   @param rate - the period, in units of 16ms                              
+Verbs::Select TickEvery(int value, Real rate) {
+   auto verb = Tick(value);
+   verb.SetRate(rate);
+   return verb;
+}
+
+/// Make a verb, that selects a ticker once, at the given uptime              
+///   @param time - the uptime, in units of 1s                                
+Verbs::Select TickAt(int value, Real time) {
+   auto verb = Tick(value);
+   verb.SetTime(time);
+   return verb;
+}
+
+
+SCENARIO("Executing flows with a budget", "[temporal][budget]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A flow, limited to a single verb per update") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.SetBudget(Budget {1});
+
+      WHEN("Three verbs are pushed at once") {
+         const auto pushed = flow.Push(Tick(1), Tick(2), Tick(3));
+
+         THEN("Only the first verb is executed, and the flow is suspended") {
+            REQUIRE(Ticker::Selections == 1);
+            REQUIRE(flow.IsSuspended());
+            REQUIRE_FALSE(pushed);
+            REQUIRE_FALSE(Budget::IsActive());
+         }
+
+         THEN("Each following update resumes where the previous one left") {
+            Many sideffects;
+            REQUIRE(flow.Update({}, sideffects));
+            REQUIRE(Ticker::Selections == 2);
+            REQUIRE(flow.IsSuspended());
+            REQUIRE_FALSE(sideffects);
+
+            REQUIRE(flow.Update({}, sideffects));
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE_FALSE(flow.IsSuspended());
+            REQUIRE(sideffects);
+         }
+
+         THEN("Completed verbs aren't executed again") {
+            Many sideffects;
+            for (int i = 0; i < 4; ++i)
+               REQUIRE(flow.Update({}, sideffects));
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE_FALSE(flow.IsSuspended());
+         }
+      }
+
+      WHEN("The budget is removed while suspended") {
+         flow.Push(Tick(1), Tick(2), Tick(3));
+         flow.SetBudget({});
+         Many sideffects;
+         REQUIRE(flow.Update({}, sideffects));
+
+         THEN("All remaining verbs are executed at once") {
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE_FALSE(flow.IsSuspended());
+            REQUIRE(sideffects);
+         }
+      }
+   }
+
+   GIVEN("A flow without a budget") {
+      Ticker::Selections = 0;
+      Temporal flow;
+
+      WHEN("Three verbs are pushed at once") {
+         const auto pushed = flow.Push(Tick(1), Tick(2), Tick(3));
+
+         THEN("All of them are executed, without suspending") {
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE_FALSE(flow.IsSuspended());
+            REQUIRE(pushed);
+         }
+      }
+   }
+}
+
+SCENARIO("Scheduling periodic flows and time points", "[temporal][schedule]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A flow with a periodic verb") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+
+      WHEN("Updated in steps shorter than the period") {
+         Many sideffects;
+         const auto pushed = Ticker::Selections;
+         REQUIRE(flow.Update(8ms, sideffects));
+         const auto early = Ticker::Selections;
+         REQUIRE(flow.Update(8ms, sideffects));
+
+         THEN("The verb is executed only once its period passes") {
+            REQUIRE(pushed == 0);
+            REQUIRE(early == 0);
+            REQUIRE(Ticker::Selections == 1);
+            REQUIRE(sideffects);
+         }
+      }
+
+      WHEN("Updated once per period") {
+         Many sideffects;
+         for (int i = 0; i < 4; ++i)
+            REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("The verb is executed on each update") {
+            REQUIRE(Ticker::Selections == 4);
+         }
+      }
+   }
+
+   GIVEN("A flow with periodic verbs of different periods") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+      flow.Push(TickEvery(2, 2));
+      flow.Push(TickEvery(3, 4));
+
+      WHEN("Updated for four of the shortest periods") {
+         Many sideffects;
+         for (int i = 0; i < 4; ++i)
+            REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("Each verb is executed only when it is due") {
+            REQUIRE(Ticker::Selections == 4 + 2 + 1);
+         }
+      }
+   }
+
+   GIVEN("A flow with a verb at a point in time") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickAt(1, 1));
+
+      WHEN("Updated before, at, and after that point") {
+         Many sideffects;
+         REQUIRE(flow.Update(500ms, sideffects));
+         const auto before = Ticker::Selections;
+         REQUIRE(flow.Update(500ms, sideffects));
+         const auto at = Ticker::Selections;
+         REQUIRE(flow.Update(1s, sideffects));
+         REQUIRE(flow.Update(1s, sideffects));
+
+         THEN("The verb is executed once, and the time point is retired") {
+            REQUIRE(before == 0);
+            REQUIRE(at == 1);
+            REQUIRE(Ticker::Selections == 1);
+         }
+      }
+   }
+}
+
+SCENARIO("Reusing outputs of stable verbs in periodic flows", "[temporal][incremental]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A periodic verb, that isn't pure") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+
+      WHEN("Updated for a number of periods") {
+         Many sideffects;
+         for (int i = 0; i < 3; ++i)
+            REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("The verb is executed on each tick") {
+            REQUIRE(Ticker::Selections == 3);
+         }
+      }
+   }
+
+   GIVEN("A periodic verb, that is pure, with a constant source") {
+      Ticker::Selections = 0;
+      Memo::MarkPure<Verbs::Select>();
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+
+      WHEN("Updated for a number of periods") {
+         TMany<Many> outputs;
+         for (int i = 0; i < 3; ++i) {
+            Many sideffects;
+            REQUIRE(flow.Update(16ms, sideffects));
+            outputs << Abandon(sideffects);
+         }
+
+         THEN("The verb is executed only on the first tick, and its output is reused") {
+            REQUIRE(Ticker::Selections == 1);
+            REQUIRE(outputs[0]);
+            REQUIRE(outputs[1] == outputs[0]);
+            REQUIRE(outputs[2] == outputs[0]);
+         }
+      }
+
+      WHEN("Another verb is linked to the periodic flow between ticks") {
+         Many sideffects;
+         REQUIRE(flow.Update(16ms, sideffects));
+         flow.Push(TickEvery(2, 1));
+         REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("Reused outputs are forgotten, and all verbs are executed again") {
+            REQUIRE(Ticker::Selections == 1 + 2);
+         }
+      }
+
+      Memo::MarkPure<Verbs::Select>(false);
+   }
+}
+
+SCENARIO("Catching up with missed periods", "[temporal][catchup]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A periodic verb, that missed four periods") {
+      Ticker::Selections = 0;
+      Ticker::Ticks = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+      Many sideffects;
+
+      WHEN("All missed periods are executed") {
+         REQUIRE(flow.GetCatchUp(1).mMode == CatchUp::All);
+         REQUIRE(flow.Update(64ms, sideffects));
+
+         THEN("The verb is executed once per period") {
+            REQUIRE(Ticker::Selections == 4);
+            REQUIRE(Ticker::Ticks == 4);
+         }
+      }
+
+      WHEN("Missed periods are coalesced") {
+         flow.SetCatchUp(1, {CatchUp::Coalesce});
+         REQUIRE(flow.Update(64ms, sideffects));
+
+         THEN("The verb is executed once, accounting for all periods") {
+            REQUIRE(Ticker::Selections == 1);
+            REQUIRE(Ticker::Ticks == 4);
+         }
+      }
+
+      WHEN("Missed periods are capped") {
+         flow.SetCatchUp(1, {CatchUp::Cap, 2});
+         REQUIRE(flow.Update(64ms, sideffects));
+
+         THEN("The verb is executed at most as many times as the limit") {
+            REQUIRE(Ticker::Selections == 2);
+            REQUIRE(Ticker::Ticks == 2);
+         }
+      }
+   }
+
+   GIVEN("A periodic verb, that missed four and a half periods") {
+      Ticker::Selections = 0;
+      Ticker::Ticks = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+      Many sideffects;
+
+      WHEN("All missed periods are executed") {
+         REQUIRE(flow.Update(72ms, sideffects));
+         const auto executed = Ticker::Selections;
+         REQUIRE(flow.Update(8ms, sideffects));
+
+         THEN("The phase of the period is kept") {
+            REQUIRE(executed == 4);
+            REQUIRE(Ticker::Selections == 5);
+         }
+      }
+
+      WHEN("Missed periods are dropped") {
+         flow.SetCatchUp(1, {CatchUp::Drop});
+         REQUIRE(flow.Update(72ms, sideffects));
+         const auto executed = Ticker::Selections;
+         REQUIRE(flow.Update(8ms, sideffects));
+         const auto early = Ticker::Selections;
+         REQUIRE(flow.Update(8ms, sideffects));
+
+         THEN("The period restarts from the single execution") {
+            REQUIRE(executed == 1);
+            REQUIRE(Ticker::Ticks == 2);
+            REQUIRE(early == 1);
+            REQUIRE(Ticker::Selections == 2);
+         }
+      }
+   }
+
+   GIVEN("A catch-up policy for the whole flow") {
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+      flow.SetCatchUp({CatchUp::Coalesce});
+      flow.Push(TickEvery(2, 2));
+      flow.SetCatchUp(2, {CatchUp::Drop});
+
+      THEN("Existing and new periodic flows get it, unless overridden") {
+         REQUIRE(flow.GetCatchUp(1).mMode == CatchUp::Coalesce);
+         REQUIRE(flow.GetCatchUp(2).mMode == CatchUp::Drop);
+         REQUIRE(flow.GetCatchUp(4).mMode == CatchUp::Coalesce);
+      }
+   }
+}
+
+SCENARIO("Updating sub-flows in parallel", "[temporal][parallel]") {
+   Verbs::Select::RegisterDispatch<Concurrent>();
+
+   GIVEN("The same periodic and timed verbs, in a sequential flow") {
+      Concurrent::Selections = 0;
+      Temporal sequential;
+      PushConcurrent(sequential, false);
+      Many expected;
+      UpdateConcurrent(sequential, expected);
+      const int executed = Concurrent::Selections;
+
+      WHEN("Updated in parallel, with a thread-safe verb") {
+         Inner::MarkThreadSafe<Verbs::Select>();
+         Concurrent::Selections = 0;
+         Session session;
+         Temporal flow;
+         PushConcurrent(flow, true);
+         flow.SetSession(&session);
+         Many sideffects;
+         UpdateConcurrent(flow, sideffects);
+         flow.SetSession(nullptr);
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Side effects are the same, and in the same order") {
+            REQUIRE(Concurrent::Selections == executed);
+            REQUIRE(sideffects == expected);
+         }
+
+         THEN("Only the updates of the flow itself are recorded") {
+            Count updates = 0;
+            Session::Entry entry;
+            Offset at = 0;
+            while (at < session.GetBytes().GetCount()) {
+               at = session.Read(at, entry);
+               updates += entry.mEvent == Session::Update;
+            }
+            REQUIRE(updates == 1 + 16);
+         }
+      }
+
+      WHEN("Updated in parallel, with a thread-unsafe verb") {
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+         Concurrent::Selections = 0;
+         Temporal flow;
+         PushConcurrent(flow, true);
+         Many sideffects;
+         UpdateConcurrent(flow, sideffects);
+
+         THEN("Sub-flows are updated one by one, with the same side effects") {
+            REQUIRE(Concurrent::Selections == executed);
+            REQUIRE(sideffects == expected);
+         }
+      }
+
+      WHEN("Updated in parallel, while a memoization table is active") {
+         Inner::MarkThreadSafe<Verbs::Select>();
+         Concurrent::Selections = 0;
+         Memo memo;
+         Temporal flow;
+         PushConcurrent(flow, true);
+         flow.SetMemo(&memo);
+         Many sideffects;
+         UpdateConcurrent(flow, sideffects);
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Sub-flows are updated one by one, with the same side effects") {
+            REQUIRE(Concurrent::Selections == executed);
+            REQUIRE(sideffects == expected);
+         }
+      }
+
+      WHEN("Updated in parallel, with a budget") {
+         Inner::MarkThreadSafe<Verbs::Select>();
+         Concurrent::Selections = 0;
+         Temporal flow;
+         PushConcurrent(flow, true);
+         flow.SetBudget(Budget {8});
+         Many sideffects;
+         REQUIRE(flow.Update(1s, sideffects));
+         Inner::MarkThreadSafe<Verbs::Select>(false);
+
+         THEN("Sub-flows share the budget, instead of each getting all of it") {
+            REQUIRE(Concurrent::Selections > 0);
+            REQUIRE(Concurrent::Selections <= 8);
+         }
+      }
+   }
+}
+
+SCENARIO("Keying sub-flows by steady clock durations", "[temporal][keys]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("Rates, that differ only by rounding errors") {
+      Temporal flow;
+      flow.SetCatchUp(0.1 * 3, {CatchUp::Drop});
+
+      THEN("They refer to the same periodic flow") {
+         REQUIRE(flow.GetCatchUp(0.3).mMode == CatchUp::Drop);
+         REQUIRE(flow.GetCatchUp(0.6).mMode == CatchUp::All);
+      }
+   }
+
+   GIVEN("Verbs at times, that differ only by rounding errors") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickAt(1, 0.1 * 3));
+      flow.Push(TickAt(2, 0.3));
+
+      WHEN("Updated right before, and exactly at that time") {
+         Many sideffects;
+         REQUIRE(flow.Update(299ms, sideffects));
+         const auto before = Ticker::Selections;
+         REQUIRE(flow.Update(1ms, sideffects));
+
+         THEN("Both are executed together, exactly on time") {
+            REQUIRE(before == 0);
+            REQUIRE(Ticker::Selections == 2);
+         }
+      }
+   }
+}
+
+SCENARIO("Enqueuing scopes from other threads", "[temporal][queue]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A queue, and many threads pushing to it at once") {
+      Inner::ScopeQueue queue;
+      std::vector<std::thread> producers;
+      for (int p = 0; p < 4; ++p) {
+         producers.emplace_back([&queue, p] {
+            for (int i = 0; i < 1000; ++i)
+               queue.Push(Many {p * 1000 + i});
+         });
+      }
+
+      for (auto& producer : producers)
+         producer.join();
+
+      WHEN("Drained") {
+         const auto scopes = queue.Drain();
+
+         THEN("All scopes are there, in the order each thread pushed them") {
+            REQUIRE(queue.IsEmpty());
+            int last[4] = {-1, -1, -1, -1};
+            Count count = 0;
+            scopes.ForEachDeep([&](const int& value) {
+               auto& previous = last[value / 1000];
+               REQUIRE(value > previous);
+               previous = value;
+               ++count;
+            });
+            REQUIRE(count == 4000);
+         }
+
+         THEN("Draining again yields nothing") {
+            REQUIRE_FALSE(queue.Drain());
+         }
+      }
+   }
+
+   GIVEN("A new flow, and verbs enqueued from another thread") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      std::thread producer {[&flow] {
+         flow.Enqueue(Tick(1), Tick(2), Tick(3));
+      }};
+      producer.join();
+
+      WHEN("Updated") {
+         const auto enqueued = Ticker::Selections;
+         Many sideffects;
+         REQUIRE(flow.Update(16ms, sideffects));
+         REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("Verbs are linked and executed once, on the first update") {
+            REQUIRE(enqueued == 0);
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE(sideffects);
+         }
+      }
+   }
+
+   GIVEN("A running flow, and a periodic verb enqueued from another thread") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      Many sideffects;
+      REQUIRE(flow.Update(16ms, sideffects));
+
+      std::thread producer {[&flow] {
+         flow.Enqueue(TickEvery(1, 1));
+      }};
+      producer.join();
+
+      WHEN("Updated once per period") {
+         for (int i = 0; i < 3; ++i)
+            REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("The verb is scheduled when linked, on the next update") {
+            REQUIRE(Ticker::Selections == 3);
+         }
+      }
+   }
+}
+
+SCENARIO("Pushing batches of scopes", "[temporal][batch]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A new flow") {
+      Ticker::Selections = 0;
+      Temporal flow;
+
+      WHEN("Many scopes are pushed at once") {
+         const auto sideffects = flow.Push(Tick(1), Tick(2), Tick(3));
+
+         THEN("All of them are linked and executed, in the order of pushing") {
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE(sideffects);
+
+            Temporal reference;
+            Many scopes;
+            scopes << Many {Tick(1)} << Many {Tick(2)} << Many {Tick(3)};
+            const auto expected = reference.PushBatch(scopes);
+            REQUIRE(sideffects == expected);
+         }
+      }
+
+      WHEN("One of the scopes fails to link") {
+         Many unlinkable;
+         unlinkable << Tick(8) << Tick(9);
+         unlinkable.MakeOr();
+         const auto sideffects = flow.Push(Tick(1), unlinkable, Tick(3));
+
+         THEN("Only that scope is skipped") {
+            REQUIRE(Ticker::Selections == 2);
+            REQUIRE(sideffects);
+         }
+      }
+
+      WHEN("One of the scopes fails to link, and failures are requested") {
+         Many unlinkable;
+         unlinkable << Tick(8) << Tick(9);
+         unlinkable.MakeOr();
+         Many scopes;
+         scopes << Many {Tick(1)} << unlinkable << Many {Tick(3)};
+         TMany<Offset> failed;
+         const auto sideffects = flow.PushBatch(scopes, failed);
+
+         THEN("The index of that scope is reported") {
+            REQUIRE(Ticker::Selections == 2);
+            REQUIRE(sideffects);
+            REQUIRE(failed.GetCount() == 1);
+            REQUIRE(failed[0] == 1);
+         }
+      }
+
+      WHEN("An empty batch is pushed") {
+         const auto sideffects = flow.PushBatch({});
+
+         THEN("Nothing happens") {
+            REQUIRE(Ticker::Selections == 0);
+            REQUIRE_FALSE(sideffects);
+         }
+      }
+   }
+}
+
+SCENARIO("Capturing and restoring snapshots", "[temporal][snapshot]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A running flow with periodic verbs") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+      flow.Push(TickEvery(2, 2));
+      Many sideffects;
+      REQUIRE(flow.Update(16ms, sideffects));
+
+      WHEN("Captured twice, with periodic ticks in between") {
+         const auto first = flow.Capture();
+         for (int i = 0; i < 4; ++i)
+            REQUIRE(flow.Update(16ms, sideffects));
+         const auto second = flow.Capture();
+
+         THEN("Nothing is cloned again, because nothing changed") {
+            REQUIRE(first.IsValid());
+            REQUIRE(second.Shares(first));
+         }
+      }
+
+      WHEN("Captured twice, with a verb linked in between") {
+         const auto first = flow.Capture();
+         flow.Push(TickEvery(3, 1));
+         const auto second = flow.Capture();
+
+         THEN("The changed flow is cloned again") {
+            REQUIRE_FALSE(second.Shares(first));
+         }
+      }
+   }
+
+   GIVEN("A suspended flow") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.SetBudget(Budget {1});
+      flow.Push(Tick(1), Tick(2), Tick(3));
+      const auto snapshot = flow.Capture();
+
+      WHEN("Updated, and then restored") {
+         Many sideffects;
+         REQUIRE(flow.Update({}, sideffects));
+         const auto resumed = Ticker::Selections;
+         const auto progressed = flow.Capture();
+         flow.Restore(snapshot);
+         REQUIRE(flow.Update({}, sideffects));
+
+         THEN("Progress is restored, and the same verb is executed again") {
+            REQUIRE(resumed == 2);
+            REQUIRE_FALSE(progressed.Shares(snapshot));
+            REQUIRE(Ticker::Selections == 3);
+            REQUIRE(flow.IsSuspended());
+         }
+      }
+   }
+}
+
+SCENARIO("Recording and replaying sessions", "[temporal][session]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A session, recorded while pushing to and updating a flow") {
+      Ticker::Selections = 0;
+      Session session;
+      Temporal flow;
+      flow.SetSession(&session);
+      flow.Push(TickEvery(1, 1));
+      flow.Push(Tick(2), Tick(3));
+      Many sideffects;
+      for (int i = 0; i < 4; ++i)
+         REQUIRE(flow.Update(16ms, sideffects));
+      flow.SetSession(nullptr);
+      const auto recorded = Ticker::Selections;
+
+      THEN("Each push and update is recorded in order") {
+         REQUIRE(recorded == 2 + 4);
+         REQUIRE(session.GetCount() == 2 + 4);
+
+         Session::Entry entry;
+         Offset at = session.Read(0, entry);
+         REQUIRE(entry.mEvent == Session::Push);
+         at = session.Read(at, entry);
+         REQUIRE(entry.mEvent == Session::Batch);
+         while (at < session.GetBytes().GetCount()) {
+            at = session.Read(at, entry);
+            REQUIRE(entry.mEvent == Session::Update);
+            REQUIRE(entry.mStamp == Time {16ms}.count());
+         }
+      }
+
+      WHEN("Loaded from its bytes") {
+         const Session loaded {session.GetBytes()};
+
+         THEN("It has the same entries") {
+            REQUIRE(loaded.GetCount() == session.GetCount());
+         }
+      }
+
+      #if LANGULUS_FEATURE(MANAGED_REFLECTION)
+         WHEN("Replayed in a new flow") {
+            Temporal replayed;
+            const auto replayedSideffects = replayed.Replay(session);
+
+            THEN("The same verbs are executed again") {
+               REQUIRE(Ticker::Selections == recorded * 2);
+               REQUIRE(replayedSideffects);
+            }
+         }
+      #endif
+   }
+}
+
+SCENARIO("Merging flows", "[temporal][merge]") {
+   Verbs::Select::RegisterDispatch<Ticker>();
+
+   GIVEN("A flow, and another one with a periodic verb halfway through its period") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      Many sideffects;
+      REQUIRE(flow.Update(8ms, sideffects));
+
+      Temporal other;
+      other.Push(TickEvery(1, 2));
+      other.SetCatchUp(2, {CatchUp::Coalesce});
+      REQUIRE(other.Update(16ms, sideffects));
+
+      WHEN("Merged by copying") {
+         flow.Merge(other);
+         REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("The periodic verb keeps its policy, and the time left until its execution") {
+            REQUIRE(flow.GetCatchUp(2).mMode == CatchUp::Coalesce);
+            REQUIRE(Ticker::Selections == 1);
+            REQUIRE(other.IsValid());
+         }
+      }
+
+      WHEN("Merged by moving") {
+         flow.Merge(std::move(other));
+         REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("The periodic verb keeps its policy, and the time left until its execution") {
+            REQUIRE(flow.GetCatchUp(2).mMode == CatchUp::Coalesce);
+            REQUIRE(Ticker::Selections == 1);
+            REQUIRE_FALSE(other.IsValid());
+         }
+      }
+   }
+
+   GIVEN("Two flows with the same periodic flow") {
+      Ticker::Selections = 0;
+      Temporal flow;
+      flow.Push(TickEvery(1, 1));
+      Temporal other;
+      other.Push(TickEvery(2, 1));
+
+      WHEN("Merged by moving") {
+         flow.Merge(std::move(other));
+         Many sideffects;
+         REQUIRE(flow.Update(16ms, sideffects));
+
+         THEN("Verbs of both are executed in a single periodic flow") {
+            REQUIRE(Ticker::Selections == 2);
+            REQUIRE_FALSE(other.IsValid());
+         }
+      }
+   }
+}
@@ -7,6 +7,11 @@
 ///                                                                           
 #include "Common.hpp"
 #include <Flow/Verbs/Select.hpp>
+#include <Flow/Verbs/Compare.hpp>
+#include <Flow/Verbs/Equal.hpp>
+#include <Flow/Verbs/Lower.hpp>
+#include <Flow/Verbs/GreaterOrEqual.hpp>
+#include <limits>
 
 
 SCENARIO("Text capsulation in verbs", "[verbs]") {
@@ -75,3 +80,96 @@ SCENARIO("Text capsulation in verbs", "[verbs]") {
 
    REQUIRE(memoryState.Assert());
 }
+
+SCENARIO("Default comparison verbs", "[verbs]") {
+   GIVEN("A block of integers") {
+      const Many context = TMany<int> {1, 5, 3, 4};
+
+      WHEN("Compared for being lower than a single integer") {
+         Verbs::Lower verb {4};
+         REQUIRE(Verbs::Lower::ExecuteDefault(context, verb));
+
+         THEN("A mask is produced, comparing each element") {
+            REQUIRE(verb.GetOutput() == TMany<bool> {true, false, true, false});
+         }
+      }
+
+      WHEN("Compared for being greater or equal to another block") {
+         Verbs::GreaterOrEqual verb {TMany<int> {1, 6, 2, 4}};
+         REQUIRE(Verbs::GreaterOrEqual::ExecuteDefault(context, verb));
+
+         THEN("A mask is produced, comparing elements pair by pair") {
+            REQUIRE(verb.GetOutput() == TMany<bool> {true, false, true, true});
+         }
+      }
+
+      WHEN("Compared three-way with a block of reals") {
+         Verbs::Compare verb {TMany<double> {2.0, 5.0, 1.0, 4.5}};
+         REQUIRE(Verbs::Compare::ExecuteDefault(context, verb));
+
+         THEN("Numbers are compared as reals") {
+            REQUIRE(verb.GetOutput() == TMany<std::int8_t> {-1, 0, 1, -1});
+         }
+      }
+
+      WHEN("Compared for equality with blocks of a different size") {
+         Verbs::Equal verb {TMany<int> {1, 5}};
+         REQUIRE(Verbs::Equal::ExecuteDefault(context, verb));
+
+         THEN("Blocks are not equal") {
+            REQUIRE(verb.GetOutput() == false);
+         }
+      }
+
+      WHEN("Compared for being lower than blocks of a different size") {
+         Verbs::Lower verb {TMany<int> {1, 5}};
+
+         THEN("Nothing is compared") {
+            REQUIRE_FALSE(Verbs::Lower::ExecuteDefault(context, verb));
+         }
+      }
+   }
+
+   GIVEN("A block of large signed integers") {
+      const Many context = TMany<std::int64_t> {
+         -1, (std::int64_t {1} << 53) + 1, std::numeric_limits<std::int64_t>::max()
+      };
+
+      WHEN("Compared for equality with unsigned integers") {
+         Verbs::Equal verb {TMany<std::uint64_t> {
+            std::numeric_limits<std::uint64_t>::max(),
+            std::uint64_t {1} << 53,
+            std::uint64_t {std::numeric_limits<std::int64_t>::max()}
+         }};
+         REQUIRE(Verbs::Equal::ExecuteDefault(context, verb));
+
+         THEN("Integers are compared exactly, regardless of signedness") {
+            REQUIRE(verb.GetOutput() == TMany<bool> {false, false, true});
+         }
+      }
+
+      WHEN("Compared three-way with unsigned integers, that differ by one") {
+         Verbs::Compare verb {TMany<std::uint64_t> {
+            0, (std::uint64_t {1} << 53), std::numeric_limits<std::uint64_t>::max()
+         }};
+         REQUIRE(Verbs::Compare::ExecuteDefault(context, verb));
+
+         THEN("Precision isn't lost by converting to reals") {
+            REQUIRE(verb.GetOutput() == TMany<std::int8_t> {-1, 1, -1});
+         }
+      }
+   }
+
+   GIVEN("A text") {
+      const Many context = Text {"tests"};
+
+      WHEN("Compared for equality with the same text") {
+         Verbs::Equal verb {Text {"tests"}};
+         REQUIRE(Verbs::Equal::ExecuteDefault(context, verb));
+
+         THEN("Reflected comparison is used") {
+            REQUIRE(verb.GetOutput() == true);
+         }
+      }
+   }
+}